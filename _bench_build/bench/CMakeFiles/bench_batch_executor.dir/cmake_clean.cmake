@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_batch_executor.dir/batch_executor.cpp.o"
+  "CMakeFiles/bench_batch_executor.dir/batch_executor.cpp.o.d"
+  "bench_batch_executor"
+  "bench_batch_executor.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_batch_executor.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_concurrent_registry.dir/concurrent_registry.cpp.o"
+  "CMakeFiles/bench_concurrent_registry.dir/concurrent_registry.cpp.o.d"
+  "bench_concurrent_registry"
+  "bench_concurrent_registry.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_concurrent_registry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_float_parsing.dir/float_parsing.cpp.o"
+  "CMakeFiles/bench_float_parsing.dir/float_parsing.cpp.o.d"
+  "bench_float_parsing"
+  "bench_float_parsing.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_float_parsing.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
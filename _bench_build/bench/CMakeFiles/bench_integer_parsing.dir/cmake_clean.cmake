@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_integer_parsing.dir/integer_parsing.cpp.o"
+  "CMakeFiles/bench_integer_parsing.dir/integer_parsing.cpp.o.d"
+  "bench_integer_parsing"
+  "bench_integer_parsing.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_integer_parsing.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_prepare.dir/prepare.cpp.o"
+  "CMakeFiles/bench_prepare.dir/prepare.cpp.o.d"
+  "bench_prepare"
+  "bench_prepare.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_prepare.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_registry_lookup.dir/registry_lookup.cpp.o"
+  "CMakeFiles/bench_registry_lookup.dir/registry_lookup.cpp.o.d"
+  "bench_registry_lookup"
+  "bench_registry_lookup.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_registry_lookup.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
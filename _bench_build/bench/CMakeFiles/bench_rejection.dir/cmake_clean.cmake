@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_rejection.dir/rejection.cpp.o"
+  "CMakeFiles/bench_rejection.dir/rejection.cpp.o.d"
+  "bench_rejection"
+  "bench_rejection.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_rejection.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_tokenize.dir/tokenize.cpp.o"
+  "CMakeFiles/bench_tokenize.dir/tokenize.cpp.o.d"
+  "bench_tokenize"
+  "bench_tokenize.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_tokenize.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/call_errors.dir/call_errors.cpp.o"
+  "CMakeFiles/call_errors.dir/call_errors.cpp.o.d"
+  "call_errors"
+  "call_errors.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/call_errors.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
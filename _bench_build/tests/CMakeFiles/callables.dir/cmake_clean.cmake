@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/callables.dir/callables.cpp.o"
+  "CMakeFiles/callables.dir/callables.cpp.o.d"
+  "callables"
+  "callables.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/callables.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/concurrent_registry.dir/concurrent_registry.cpp.o"
+  "CMakeFiles/concurrent_registry.dir/concurrent_registry.cpp.o.d"
+  "concurrent_registry"
+  "concurrent_registry.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/concurrent_registry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/float_parsing.dir/float_parsing.cpp.o"
+  "CMakeFiles/float_parsing.dir/float_parsing.cpp.o.d"
+  "float_parsing"
+  "float_parsing.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/float_parsing.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
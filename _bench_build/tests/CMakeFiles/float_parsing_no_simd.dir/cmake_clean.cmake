@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/float_parsing_no_simd.dir/float_parsing.cpp.o"
+  "CMakeFiles/float_parsing_no_simd.dir/float_parsing.cpp.o.d"
+  "float_parsing_no_simd"
+  "float_parsing_no_simd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/float_parsing_no_simd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/float_parsing_sse41.dir/float_parsing.cpp.o"
+  "CMakeFiles/float_parsing_sse41.dir/float_parsing.cpp.o.d"
+  "float_parsing_sse41"
+  "float_parsing_sse41.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/float_parsing_sse41.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/frozen_registry.dir/frozen_registry.cpp.o"
+  "CMakeFiles/frozen_registry.dir/frozen_registry.cpp.o.d"
+  "frozen_registry"
+  "frozen_registry.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/frozen_registry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
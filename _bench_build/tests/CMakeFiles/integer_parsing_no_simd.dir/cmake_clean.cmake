@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/integer_parsing_no_simd.dir/integer_parsing.cpp.o"
+  "CMakeFiles/integer_parsing_no_simd.dir/integer_parsing.cpp.o.d"
+  "integer_parsing_no_simd"
+  "integer_parsing_no_simd.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/integer_parsing_no_simd.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/integer_parsing_sse41.dir/integer_parsing.cpp.o"
+  "CMakeFiles/integer_parsing_sse41.dir/integer_parsing.cpp.o.d"
+  "integer_parsing_sse41"
+  "integer_parsing_sse41.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/integer_parsing_sse41.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/overloads.dir/overloads.cpp.o"
+  "CMakeFiles/overloads.dir/overloads.cpp.o.d"
+  "overloads"
+  "overloads.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/overloads.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
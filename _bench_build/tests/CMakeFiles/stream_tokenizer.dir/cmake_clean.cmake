@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/stream_tokenizer.dir/stream_tokenizer.cpp.o"
+  "CMakeFiles/stream_tokenizer.dir/stream_tokenizer.cpp.o.d"
+  "stream_tokenizer"
+  "stream_tokenizer.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/stream_tokenizer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
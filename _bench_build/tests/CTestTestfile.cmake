@@ -0,0 +1,32 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_bench_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(allocations "/root/repo/_bench_build/tests/allocations")
+set_tests_properties(allocations PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;27;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(concurrent_registry "/root/repo/_bench_build/tests/concurrent_registry")
+set_tests_properties(concurrent_registry PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;28;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(stream_tokenizer "/root/repo/_bench_build/tests/stream_tokenizer")
+set_tests_properties(stream_tokenizer PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;29;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(frozen_registry "/root/repo/_bench_build/tests/frozen_registry")
+set_tests_properties(frozen_registry PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;30;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(overloads "/root/repo/_bench_build/tests/overloads")
+set_tests_properties(overloads PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;31;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(callables "/root/repo/_bench_build/tests/callables")
+set_tests_properties(callables PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;32;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(call_errors "/root/repo/_bench_build/tests/call_errors")
+set_tests_properties(call_errors PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;33;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(integer_parsing "/root/repo/_bench_build/tests/integer_parsing")
+set_tests_properties(integer_parsing PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;39;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(integer_parsing_no_simd "/root/repo/_bench_build/tests/integer_parsing_no_simd")
+set_tests_properties(integer_parsing_no_simd PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;40;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(integer_parsing_sse41 "/root/repo/_bench_build/tests/integer_parsing_sse41")
+set_tests_properties(integer_parsing_sse41 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;43;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(float_parsing "/root/repo/_bench_build/tests/float_parsing")
+set_tests_properties(float_parsing PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;39;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(float_parsing_no_simd "/root/repo/_bench_build/tests/float_parsing_no_simd")
+set_tests_properties(float_parsing_no_simd PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;40;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(float_parsing_sse41 "/root/repo/_bench_build/tests/float_parsing_sse41")
+set_tests_properties(float_parsing_sse41 PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;24;add_test;/root/repo/tests/CMakeLists.txt;43;cmd_test;/root/repo/tests/CMakeLists.txt;0;")
@@ -0,0 +1,65 @@
+// lines per second of batch_executor on a CPU-bound batch, for 1 thread up to the hardware
+// threads, against registry::call_batch on the calling thread
+
+#include "cmd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// rounds dependent multiplications, a few hundred nanoseconds for the rounds used
+static std::uint64_t work(std::uint64_t seed, int rounds)
+{
+    for(int i = 0; i < rounds; i++)
+        seed = seed * 6364136223846793005 + 1442695040888963407;
+    return seed;
+}
+
+// lines per second of calling batch until a while has passed
+template <typename F>
+static double lines_per_second(size_t lines, F batch)
+{
+    using clock = std::chrono::steady_clock;
+    size_t n = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed;
+    do
+    {
+        batch();
+        n += lines;
+        elapsed = clock::now() - start;
+    } while(elapsed.count() < 0.5);
+    return double(n) / elapsed.count();
+}
+
+int main()
+{
+    cmd::registry r;
+    r.register_func("work", &work);
+
+    std::vector<std::string> storage;
+    for(int i = 0; i < 10000; i++)
+        storage.push_back("work " + std::to_string(i) + " " + std::to_string(200 + i % 200));
+    std::vector<std::string_view> lines(storage.begin(), storage.end());
+    cmd::batch_result results;
+
+    auto sequential = lines_per_second(lines.size(), [&] { r.call_batch(lines, results); });
+    std::printf("registry::call_batch: %.2f million lines/s\n", sequential / 1e6);
+    std::printf("threads  million lines/s  speedup\n");
+
+    auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+    // doubling the threads, ending with all of them
+    for(unsigned threads = 1;; threads = std::min(2 * threads, max_threads))
+    {
+        cmd::batch_executor ex{threads};
+        auto rate = lines_per_second(lines.size(), [&] { ex.call_batch(r, lines, results); });
+        std::printf("%7u  %15.2f  %7.2f\n", threads, rate / 1e6, rate / sequential);
+        if(threads == max_threads)
+            break;
+    }
+}
@@ -0,0 +1,91 @@
+// calls per second of concurrent_registry readers against a registry behind a mutex, for
+// 1 thread up to the hardware threads, both with a writer updating every millisecond
+
+#include "cmd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static int add(int a, int b) { return a + b; }
+
+// runs call on each of threads threads and update on another for a while, returns the calls
+// per second
+template <typename Call, typename Update>
+static double calls_per_second(unsigned threads, Call call, Update update)
+{
+    using clock = std::chrono::steady_clock;
+    constexpr auto duration = std::chrono::milliseconds{500};
+    std::atomic<bool> done = false;
+    std::atomic<std::uint64_t> calls = 0;
+
+    std::vector<std::thread> pool;
+    for(unsigned t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&] {
+            std::uint64_t n = 0;
+            call(done, n);
+            calls += n;
+        });
+    }
+    auto start = clock::now();
+    for(int k = 0; clock::now() - start < duration; k++)
+    {
+        update(k);
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    done = true;
+    for(auto& t : pool)
+        t.join();
+    return double(calls) / std::chrono::duration<double>(clock::now() - start).count();
+}
+
+int main()
+{
+    cmd::registry base;
+    for(int i = 0; i < 100; i++)
+        base.register_func("add" + std::to_string(i), &add);
+
+    cmd::concurrent_registry cr{base};
+    auto concurrent = [&](std::atomic<bool>& done, std::uint64_t& n) {
+        cmd::concurrent_registry::reader rd{cr};
+        for(; !done.load(std::memory_order_relaxed); n++)
+            if(!rd.call("add42 1 2"))
+                std::abort();
+    };
+    auto concurrent_update = [&](int k) {
+        cr.register_func("tmp", [k] { return k; });
+    };
+
+    cmd::registry r{base};
+    std::mutex mtx;
+    auto locked = [&](std::atomic<bool>& done, std::uint64_t& n) {
+        cmd::call_context ctx;
+        for(; !done.load(std::memory_order_relaxed); n++)
+        {
+            std::lock_guard lock{mtx};
+            if(!r.call(ctx, "add42 1 2"))
+                std::abort();
+        }
+    };
+    auto locked_update = [&](int k) {
+        std::lock_guard lock{mtx};
+        r.register_func("tmp", [k] { return k; });
+    };
+
+    std::printf("threads  concurrent_registry  mutex        (million calls/s)\n");
+    auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+    // doubling the threads, ending with all of them
+    for(unsigned threads = 1;; threads = std::min(2 * threads, max_threads))
+    {
+        auto c = calls_per_second(threads, concurrent, concurrent_update);
+        auto m = calls_per_second(threads, locked, locked_update);
+        std::printf("%7u  %19.2f  %11.2f\n", threads, c / 1e6, m / 1e6);
+        if(threads == max_threads)
+            break;
+    }
+}
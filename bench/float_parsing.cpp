@@ -0,0 +1,115 @@
+// nanoseconds per number of detail::parse_float against std::from_chars, over several kinds of
+// numbers
+
+#include "cmd.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static volatile double checksum = 0;
+
+// nanoseconds per number of parsing every number with parse, over a while
+template <typename T, typename F>
+static double ns_per_number(const std::vector<std::string>& numbers, F parse)
+{
+    using clock = std::chrono::steady_clock;
+    size_t n = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed;
+    do
+    {
+        T sum = 0;
+        for(auto& s : numbers)
+        {
+            T x = 0;
+            parse(s.data(), s.data() + s.size(), x);
+            sum += x;
+        }
+        checksum = checksum + double(sum);
+        n += numbers.size();
+        elapsed = clock::now() - start;
+    } while(elapsed.count() < 0.2);
+    return elapsed.count() * 1e9 / double(n);
+}
+
+// 4096 numbers made by make(rng)
+template <typename F>
+static std::vector<std::string> numbers_of(F make)
+{
+    std::mt19937_64 rng{7};
+    std::vector<std::string> numbers;
+    for(int i = 0; i < 4096; i++)
+        numbers.push_back(make(rng));
+    return numbers;
+}
+
+// the shortest representation of a random finite T
+template <typename T>
+static std::string shortest(std::mt19937_64& rng)
+{
+    while(true)
+    {
+        using B = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+        auto bits = B(rng());
+        T x;
+        std::memcpy(&x, &bits, sizeof x);
+        if(std::isfinite(x))
+        {
+            char buf[64];
+            return {buf, std::to_chars(buf, buf + sizeof buf, x).ptr};
+        }
+    }
+}
+
+static std::string digits(std::mt19937_64& rng, int n)
+{
+    std::string s;
+    for(int i = 0; i < n; i++)
+        s += char('0' + rng() % 10);
+    return s;
+}
+
+template <typename T>
+static void compare(const char* type, const char* kind, const std::vector<std::string>& numbers)
+{
+    auto ours = ns_per_number<T>(numbers, [](const char* f, const char* l, T& x) {
+        return cmd::detail::parse_float(f, l, x);
+    });
+    auto theirs = ns_per_number<T>(
+        numbers, [](const char* f, const char* l, T& x) { return std::from_chars(f, l, x); });
+    std::printf("%-7s %-24s %8.2f ns %8.2f ns %8.2fx\n", type, kind, ours, theirs,
+                theirs / ours);
+}
+
+int main()
+{
+    std::printf("%-7s %-24s %11s %11s %9s\n", "type", "numbers", "parse_float", "from_chars",
+                "speedup");
+    auto integers = numbers_of([](auto& rng) { return std::to_string(rng() % 100000); });
+    auto short_decimals =
+        numbers_of([](auto& rng) { return std::to_string(rng() % 1000) + "." + digits(rng, 2); });
+    auto unit = numbers_of([](auto& rng) { return "0." + digits(rng, 17); });
+    auto scientific = numbers_of([](auto& rng) {
+        auto e = std::to_string(int(rng() % 600) - 300);
+        return digits(rng, 1) + "." + digits(rng, 15) + "e" + e;
+    });
+    auto long_mantissas = numbers_of([](auto& rng) { return "1." + digits(rng, 40); });
+
+    for(auto [kind, numbers] : {std::pair{"integers", &integers},
+                                {"short decimals", &short_decimals},
+                                {"0.17 digits", &unit},
+                                {"16 digits, exponent", &scientific},
+                                {"41 digits", &long_mantissas}})
+    {
+        compare<double>("double", kind, *numbers);
+        compare<float>("float", kind, *numbers);
+    }
+    compare<double>("double", "shortest random doubles", numbers_of(shortest<double>));
+    compare<float>("float", "shortest random floats", numbers_of(shortest<float>));
+}
@@ -0,0 +1,82 @@
+// nanoseconds per number of detail::parse_integer against std::from_chars, over numbers of
+// several lengths. Build with -DCMAKE_CXX_FLAGS=-msse4.1, or CMD_NO_SIMD, to compare paths.
+
+#include "cmd.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+static volatile std::uint64_t checksum = 0;
+
+// nanoseconds per number of parsing every number in text with parse, over a while
+template <typename T, typename F>
+static double ns_per_number(const std::vector<std::string>& numbers, F parse)
+{
+    using clock = std::chrono::steady_clock;
+    size_t n = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed;
+    do
+    {
+        std::uint64_t sum = 0;
+        for(auto& s : numbers)
+        {
+            T x = 0;
+            parse(s.data(), s.data() + s.size(), x);
+            sum += std::uint64_t(x);
+        }
+        checksum = checksum + sum;
+        n += numbers.size();
+        elapsed = clock::now() - start;
+    } while(elapsed.count() < 0.2);
+    return elapsed.count() * 1e9 / double(n);
+}
+
+// digits random digits, without leading zeros, negative half the time if T is signed
+template <typename T>
+static std::vector<std::string> numbers_of(int digits)
+{
+    std::mt19937_64 rng{std::uint64_t(digits)};
+    std::vector<std::string> numbers;
+    for(int i = 0; i < 4096; i++)
+    {
+        std::string s;
+        if(std::is_signed_v<T> && rng() % 2)
+            s += '-';
+        s += char('1' + rng() % 9);
+        for(int d = 1; d < digits; d++)
+            s += char('0' + rng() % 10);
+        numbers.push_back(s);
+    }
+    return numbers;
+}
+
+template <typename T>
+static void compare(const char* type, std::initializer_list<int> lengths)
+{
+    for(int digits : lengths)
+    {
+        auto numbers = numbers_of<T>(digits);
+        auto ours = ns_per_number<T>(numbers, [](const char* f, const char* l, T& x) {
+            return cmd::detail::parse_integer(f, l, x);
+        });
+        auto theirs = ns_per_number<T>(
+            numbers, [](const char* f, const char* l, T& x) { return std::from_chars(f, l, x); });
+        std::printf("%-10s %6d %10.2f ns %10.2f ns %8.2fx\n", type, digits, ours, theirs,
+                    theirs / ours);
+    }
+}
+
+int main()
+{
+    std::printf("%-10s %6s %13s %13s %9s\n", "type", "digits", "parse_integer", "from_chars",
+                "speedup");
+    compare<int>("int", {1, 2, 4, 8, 9});
+    compare<long long>("long long", {1, 4, 8, 12, 16, 18});
+    compare<std::uint64_t>("uint64_t", {1, 8, 16, 19});
+}
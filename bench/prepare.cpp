@@ -0,0 +1,62 @@
+// nanoseconds per call of a prepared command against calling the whole line each time
+
+#include "cmd.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+static volatile size_t checksum = 0;
+
+// nanoseconds per call of f, over a while
+template <typename F>
+static double ns_per_call(F f)
+{
+    using clock = std::chrono::steady_clock;
+    size_t n = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed;
+    do
+    {
+        for(int i = 0; i < 1000; i++)
+            f();
+        n += 1000;
+        elapsed = clock::now() - start;
+    } while(elapsed.count() < 0.3);
+    return elapsed.count() * 1e9 / double(n);
+}
+
+static double scale(double x, double k, std::string_view unit)
+{
+    return unit == "km" ? x * k * 1000 : x * k;
+}
+
+int main()
+{
+    cmd::registry r;
+    r.register_func("scale", &scale);
+    for(int i = 0; i < 100; i++)
+        r.register_func("other" + std::to_string(i), &scale);
+
+    constexpr std::string_view line = "scale 3.25 1.5e3 'km'";
+    cmd::call_context ctx;
+    std::string out;
+
+    std::printf("%-32s %6.1f ns\n", "registry::call(line)",
+                ns_per_call([&] { checksum = checksum + r.call(line)->size(); }));
+    std::printf("%-32s %6.1f ns\n", "registry::call(ctx, line)",
+                ns_per_call([&] { checksum = checksum + r.call(ctx, line)->size(); }));
+
+    auto constant = r.prepare(line);
+    std::printf("%-32s %6.1f ns\n", "prepared, no placeholders", ns_per_call([&] {
+                    out.clear();
+                    checksum = checksum + constant.invoke(out);
+                }));
+
+    auto one = r.prepare("scale ? 1.5e3 'km'");
+    std::printf("%-32s %6.1f ns\n", "prepared, bind(\"3.25\")", ns_per_call([&] {
+                    out.clear();
+                    checksum = checksum + one.bind("3.25").invoke(out);
+                }));
+}
@@ -0,0 +1,71 @@
+// nanoseconds per lookup and per call in registries of 10, 1k and 100k commands, frozen and not
+
+#include "cmd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+static volatile size_t checksum = 0;
+
+// nanoseconds per call of f(i) for i cycling through [0, n), over a while
+template <typename F>
+static double ns_per_call(size_t n, F f)
+{
+    using clock = std::chrono::steady_clock;
+    size_t calls = 0, i = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed;
+    do
+    {
+        for(int k = 0; k < 1000; k++)
+        {
+            f(i);
+            if(++i == n)
+                i = 0;
+        }
+        calls += 1000;
+        elapsed = clock::now() - start;
+    } while(elapsed.count() < 0.3);
+    return elapsed.count() * 1e9 / double(calls);
+}
+
+static int nop() { return 0; }
+
+int main()
+{
+    std::printf("%8s %-8s %10s %10s %10s\n", "commands", "", "hit", "miss", "call");
+    for(size_t n : {10, 1000, 100000})
+    {
+        cmd::registry r;
+        std::vector<std::string> names, missing;
+        for(size_t i = 0; i < n; i++)
+        {
+            names.push_back("command_" + std::to_string(i));
+            missing.push_back("missing_" + std::to_string(i));
+            r.register_func(names.back(), &nop);
+        }
+        // looked up in random order so that large tables miss the cache as they would
+        std::mt19937 rng{42};
+        std::shuffle(names.begin(), names.end(), rng);
+        std::shuffle(missing.begin(), missing.end(), rng);
+
+        cmd::call_context ctx;
+        for(int frozen = 0; frozen < 2; frozen++)
+        {
+            if(frozen && !r.freeze())
+                std::printf("freezing %zu commands failed\n", n);
+            auto hit =
+                ns_per_call(n, [&](size_t i) { checksum = checksum + r.contains(names[i]); });
+            auto miss =
+                ns_per_call(n, [&](size_t i) { checksum = checksum + r.contains(missing[i]); });
+            auto call = ns_per_call(
+                n, [&](size_t i) { checksum = checksum + r.call(ctx, names[i])->size(); });
+            std::printf("%8zu %-8s %7.1f ns %7.1f ns %7.1f ns\n", n, frozen ? "frozen" : "mutable",
+                        hit, miss, call);
+        }
+    }
+}
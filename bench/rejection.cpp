@@ -0,0 +1,67 @@
+// nanoseconds to reject oversized lines that are invalid from their first arguments, against
+// tokenizing the whole line as calls did before scanning lazily
+
+#include "cmd.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+static volatile size_t checksum = 0;
+
+// nanoseconds per call of f, over a while
+template <typename F>
+static double ns_per_call(F f)
+{
+    using clock = std::chrono::steady_clock;
+    size_t n = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed;
+    do
+    {
+        for(int i = 0; i < 16; i++)
+            f();
+        n += 16;
+        elapsed = clock::now() - start;
+    } while(elapsed.count() < 0.2);
+    return elapsed.count() * 1e9 / double(n);
+}
+
+static int add(int a, int b) { return a + b; }
+
+int main()
+{
+    cmd::registry r;
+    r.register_func("add", &add);
+    // overloads scan the whole line to count its tokens
+    r.register_overload("sum", &add);
+    r.register_overload("sum", [](int a, int b, int c) { return a + b + c; });
+
+    cmd::call_context ctx;
+    cmd::token_list toks;
+
+    std::printf("%10s %12s %12s %12s %12s %12s %12s\n", "line bytes", "tokenize", "extra args",
+                "try_call", "bad arg", "unknown", "overloaded");
+    for(size_t size : {1 << 10, 1 << 16, 1 << 20})
+    {
+        std::string tail;
+        for(int i = 0; tail.size() < size; i++)
+            tail += i % 4 == 3 ? " 'quoted token'" : " 12345";
+
+        auto extra = "add 1 2" + tail;
+        auto bad = "add x" + tail;
+        auto unknown = "missing" + tail;
+        auto overloaded = "sum 1 2 3" + tail;
+
+        auto reject = [&](const std::string& line) {
+            return ns_per_call([&] { checksum = checksum + !r.call(ctx, line); });
+        };
+        std::printf("%10zu %9.0f ns %9.0f ns %9.0f ns %9.0f ns %9.0f ns %9.0f ns\n", size,
+                    ns_per_call([&] { checksum = checksum + cmd::tokenize(extra, toks); }),
+                    reject(extra), ns_per_call([&] {
+                        checksum = checksum + size_t(r.try_call(ctx, extra).error().code);
+                    }),
+                    reject(bad), reject(unknown), reject(overloaded));
+    }
+}
@@ -0,0 +1,83 @@
+// bytes per second of tokenizing lines of tokens of several lengths, against finding the
+// delimiters with std::string_view::find_first_of
+
+#include "cmd.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// the positions found, so that finding them isn't optimized away
+static volatile size_t checksum = 0;
+
+// bytes per second of calling f on line for a while
+template <typename F>
+static double bytes_per_second(std::string_view line, F f)
+{
+    using clock = std::chrono::steady_clock;
+    size_t bytes = 0;
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed;
+    do
+    {
+        for(int i = 0; i < 16; i++)
+            bytes += f(line);
+        elapsed = clock::now() - start;
+    } while(elapsed.count() < 0.2);
+    return double(bytes) / elapsed.count();
+}
+
+int main()
+{
+    std::printf("token bytes  tokenize  find_any  find_first_of  (GB/s over 64 KB lines)\n");
+    for(size_t len : {4, 16, 64, 256, 4096})
+    {
+        // tokens of len bytes separated by spaces, every fourth quoted
+        std::string line;
+        for(int i = 0; line.size() < 65536; i++)
+        {
+            std::string tok(len, char('a' + i % 26));
+            line += i % 4 == 3 ? "'" + tok + "' " : tok + " ";
+        }
+
+        std::vector<std::string_view> toks;
+        std::string storage;
+        auto tokenize = [&](std::string_view l) {
+            toks.clear();
+            cmd::token_cursor c{l, storage};
+            while(auto tok = c.next())
+                toks.push_back(*tok);
+            checksum = checksum + toks.size();
+            return l.size();
+        };
+        // the delimiters alone, which bounds tokenizing
+        auto find_any = [](std::string_view l) {
+            size_t n = l.size();
+            while(true)
+            {
+                auto i = cmd::detail::simd::find_any<' ', '"', '\''>(l);
+                if(i == l.npos)
+                    return n;
+                checksum = checksum + i;
+                l.remove_prefix(i + 1);
+            }
+        };
+        auto find_first_of = [](std::string_view l) {
+            size_t n = l.size();
+            while(true)
+            {
+                auto i = l.find_first_of(" \"'");
+                if(i == l.npos)
+                    return n;
+                checksum = checksum + i;
+                l.remove_prefix(i + 1);
+            }
+        };
+
+        std::printf("%11zu  %8.2f  %8.2f  %13.2f\n", len, bytes_per_second(line, tokenize) / 1e9,
+                    bytes_per_second(line, find_any) / 1e9,
+                    bytes_per_second(line, find_first_of) / 1e9);
+    }
+}
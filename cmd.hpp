@@ -1,299 +1,4449 @@
-#ifndef CMD_HPP_INCLUDED
-#define CMD_HPP_INCLUDED
-
-#include <array>
-#include <charconv>
-#include <optional>
-#include <span>
-#include <string>
-#include <string_view>
-#include <tuple>
-#include <unordered_map>
-#include <utility>
-#include <vector>
-
-namespace cmd
-{
-    using std::size_t;
-
-    namespace detail
-    {
-        // indexing helper, see index_upto
-        template <typename F, size_t... Is>
-        inline constexpr decltype(auto) index_over(F&& f, std::index_sequence<Is...>)
-        {
-            return std::forward<F>(f)(std::integral_constant<size_t, Is>{}...);
-        }
-
-        // indexing helper, use as
-        //      index_upto<N>([&](auto... is){});
-        // where is are integral constants in [0, N).
-        template <size_t N, typename F>
-        inline constexpr decltype(auto) index_upto(F&& f)
-        {
-            return index_over(std::forward<F>(f), std::make_index_sequence<N>{});
-        }
-    } // namespace detail
-
-    template <typename>
-    struct must_specialize : std::false_type
-    {
-    };
-
-    // from_string is the customization point for converting a token to the argument type.
-    // from_string is already specialized for std::string_view, std::string, integral types and
-    // floating types.
-    template <typename>
-    struct from_string;
-
-    // Integral types and floating types depends on std::from_chars,
-    // which most compilers haven't implemented yet, sadly.
-    template <typename T>
-    requires requires(std::string_view tok, T x)
-    {
-        std::from_chars(tok.data(), tok.data() + tok.size(), x);
-    }
-    struct from_string<T>
-    {
-        std::optional<T> operator()(std::string_view tok)
-        {
-            T x = 0;
-            auto res = std::from_chars(tok.data(), tok.data() + tok.size(), x);
-            if(res.ec != std::errc{})
-                return {};
-            return x;
-        }
-    };
-
-    template <>
-    struct from_string<std::string_view>
-    {
-        std::optional<std::string_view> operator()(std::string_view tok) { return tok; }
-    };
-
-    template <>
-    struct from_string<std::string>
-    {
-        std::optional<std::string> operator()(std::string tok) { return tok; }
-    };
-
-    // to_string is the customization point for converting the return type to std::string.
-    // to_string is already specialized for void, std::string, integral types and floating types.
-    template <typename T>
-    struct to_string;
-
-    template <>
-    struct to_string<void>
-    {
-    };
-
-    template <typename T>
-    requires requires(T& x, char* buf)
-    {
-        std::to_chars(buf, buf, x);
-    }
-    struct to_string<T>
-    {
-        std::string operator()(T x)
-        {
-            char buf[32]; // TODO: check correct length
-            auto res = std::to_chars(buf, buf + sizeof(buf), x);
-            return {buf, res.ptr};
-        }
-    };
-
-    template <>
-    struct to_string<std::string>
-    {
-        std::string operator()(std::string&& x) { return std::move(x); }
-    };
-
-    template <typename T>
-    concept from_stringable = requires(std::string_view s, from_string<std::remove_cvref_t<T>> fs)
-    {
-        bool(fs(s));
-        {
-            *fs(s)
-        }
-        ->std::convertible_to<std::remove_cvref_t<T>>;
-    };
-
-    template <typename T>
-    concept to_stringable = std::is_void_v<T> || requires(T x)
-    {
-        to_string<std::remove_cvref_t<T>>{}(x);
-    };
-
-    template <typename R, typename... Args>
-    concept stringable = (to_stringable<R> && ... && from_stringable<Args>);
-
-    // erased_func is a type-erased function which can be called with a span of strings,
-    // where each string is converted to their respective argument by from_string.
-    // erased_func can be constructed from a function pointer.
-    class erased_func
-    {
-        using untyped_func = void();
-
-        template <typename R, typename... Args>
-        static std::optional<std::string> dispatch_func(untyped_func* uf,
-                                                        std::span<std::string> toks)
-        {
-            if(toks.size() != sizeof...(Args))
-                return {};
-
-            return detail::index_upto<sizeof...(Args)>(
-                [&](auto... is) -> std::optional<std::string> {
-                    auto optargs = std::tuple{
-                        from_string<std::remove_cvref_t<Args>>{}(std::move(toks[is]))...};
-                    if((!get<is>(optargs) || ...))
-                        return {};
-                    auto fn = (R(*)(Args...))uf;
-                    using rR = std::remove_cvref_t<R>;
-                    if constexpr(!std::is_void_v<rR>)
-                    {
-                        auto ret = fn(std::forward<Args>(*get<is>(optargs))...);
-                        return to_string<rR>{}(std::move(ret));
-                    }
-                    else
-                    {
-                        fn(std::forward<Args>(*get<is>(optargs))...);
-                        return "";
-                    }
-                });
-        }
-
-      public:
-        erased_func() = default;
-        template <typename R, typename... Args>
-        requires stringable<R, Args...> erased_func(R (*fn)(Args...))
-            : dispatch{dispatch_func<R, Args...>}, fn{(untyped_func*)fn}
-        {
-        }
-
-        std::optional<std::string> call(std::span<std::string> toks) { return dispatch(fn, toks); }
-
-      private:
-        std::optional<std::string> (*dispatch)(untyped_func*, std::span<std::string>) = nullptr;
-        untyped_func* fn = nullptr;
-    };
-
-    // tokenize has bash semantics, e.g.
-    //      a b'c d'e f'"g"'
-    // will be tokenized as
-    //      a
-    //      bc de
-    //      f"g"
-    // returns the tokens and whether there is an unclosed quote.
-    std::pair<std::vector<std::string>, char> tokenize(std::string_view line)
-    {
-        bool sq = false, dq = false; // within single and double quotes
-        std::vector<std::string> toks;
-        std::string cur;
-        while(line.size() > 0)
-        {
-            if(sq)
-            {
-                auto i = line.find('\'');
-                if(i == line.npos)
-                {
-                    cur += line;
-                    toks.push_back(std::move(cur));
-                    return std::pair{toks, '\''};
-                }
-                cur += line.substr(0, i);
-                line = line.substr(i + 1);
-                sq = false;
-            }
-            else if(dq)
-            {
-                auto i = line.find('"');
-                if(i == line.npos)
-                {
-                    cur += line;
-                    toks.push_back(std::move(cur));
-                    return std::pair{toks, '"'};
-                }
-                cur += line.substr(0, i);
-                line = line.substr(i + 1);
-                dq = false;
-            }
-            else
-            {
-                auto i = line.find_first_of(" \"'");
-                if(i == line.npos)
-                {
-                    cur += line;
-                    toks.push_back(std::move(cur));
-                    return std::pair{toks, 0};
-                }
-
-                cur += line.substr(0, i);
-                switch(line[i])
-                {
-                case ' ':
-                    if(cur.size() > 0)
-                    {
-                        toks.push_back(std::move(cur));
-                        cur = {};
-                    }
-                    break;
-                case '\'': sq = true; break;
-                case '"': dq = true; break;
-                }
-                line = line.substr(i + 1);
-            }
-        }
-
-        if(cur.size() > 0)
-            toks.push_back(std::move(cur));
-        return std::pair{toks, 0};
-    }
-
-    // registry holds registered functions that can later be called command line style with
-    // full type-safety, e.g.
-    //      int foo(int);
-    //      registry r;
-    //      r.register_func("foo", &foo);
-    //      auto opt = r.call("foo 42");
-    // calls foo(42) and returns  the result as as an std::optional<std::string>.
-    // The arguments are parsed like bash, supporting quoting.
-    // If parsing fails, opt is empty and the function isn't called.
-    // The string is tokenized and converted to their respective arguments by calling
-    //      from_string<T>{}(token);
-    // The return value of the function is converted to std::string by
-    //      to_string<T>{}(return_value);
-    class registry
-    {
-      public:
-        std::optional<std::string> call(std::string_view line)
-        {
-            auto [toks, quote] = tokenize(line);
-            if(quote || toks.empty())
-                return {};
-
-            return call(toks[0], std::span{toks}.subspan(1));
-        }
-
-        std::optional<std::string> call(const std::string& name, std::span<std::string> toks)
-        {
-            auto it = table.find(name);
-            if(it == table.end())
-                return {};
-
-            auto ef = it->second;
-            return ef.call(toks);
-        }
-
-        template <typename R, typename... Args>
-        requires stringable<R, Args...> void register_func(const std::string& name,
-                                                           R (*fn)(Args...))
-        {
-            table[name] = fn;
-        }
-
-      private:
-        std::unordered_map<std::string, erased_func> table;
-    };
-} // namespace cmd
-
-#endif
+#ifndef CMD_HPP_INCLUDED
+#define CMD_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cfloat>
+#include <charconv>
+#include <compare>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Define CMD_NO_SIMD to scan with the standard library only and parse numbers without SSE4.1.
+// SSE4.1 isn't detected at runtime, it is used when the compiler targets it.
+#if !defined(CMD_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define CMD_SIMD_X86
+#include <immintrin.h>
+#ifdef __SSE4_1__
+#define CMD_SIMD_SSE41
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CMD_TARGET_AVX2
+#define CMD_ALWAYS_INLINE __forceinline
+#else
+#define CMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define CMD_ALWAYS_INLINE inline __attribute__((always_inline))
+#endif
+#endif
+
+// Define CMD_FUNC_BUFFER_SIZE to the size in bytes of callables erased_func stores without
+// allocating, at least the size of a pointer. Larger callables are stored on the heap.
+#ifndef CMD_FUNC_BUFFER_SIZE
+#define CMD_FUNC_BUFFER_SIZE sizeof(void*)
+#endif
+
+namespace cmd
+{
+    using std::size_t;
+
+    namespace detail
+    {
+        // indexing helper, see index_upto
+        template <typename F, size_t... Is>
+        inline constexpr decltype(auto) index_over(F&& f, std::index_sequence<Is...>)
+        {
+            return std::forward<F>(f)(std::integral_constant<size_t, Is>{}...);
+        }
+
+        // indexing helper, use as
+        //      index_upto<N>([&](auto... is){});
+        // where is are integral constants in [0, N).
+        template <size_t N, typename F>
+        inline constexpr decltype(auto) index_upto(F&& f)
+        {
+            return index_over(std::forward<F>(f), std::make_index_sequence<N>{});
+        }
+    } // namespace detail
+
+    template <typename>
+    struct must_specialize : std::false_type
+    {
+    };
+
+    // whether from_string converts a token that only starts with a value, such as "12abc".
+    // strict rejects it, lenient converts the prefix and ignores the rest.
+    enum class parse_policy
+    {
+        strict,
+        lenient,
+    };
+
+    // from_string is the customization point for converting a token to the argument type.
+    // from_string is already specialized for std::string_view, std::string, integral types and
+    // floating types, for either policy. Calls convert with the default, strict.
+    // It may also convert a token where it lies in the line with
+    //      std::optional<T> operator()(const char*& first, const char* last);
+    // which parses a prefix of [first, last) and advances first past it, see
+    // token_cursor::parse_next.
+    template <typename, parse_policy = parse_policy::strict>
+    struct from_string;
+
+    namespace detail
+    {
+        // the number of leading digits of chunk, in memory order on a little-endian machine.
+        // Each byte that isn't a digit gets its high bit set, bytes after it may be garbled by
+        // carries but only the first matters.
+        inline int leading_digits(std::uint64_t chunk)
+        {
+            auto m = ((chunk + 0x4646464646464646) | (chunk - 0x3030303030303030)) &
+                     0x8080808080808080;
+            return m ? std::countr_zero(m) / 8 : 8;
+        }
+
+        // the value of the 8 digits of chunk, in memory order on a little-endian machine
+        inline std::uint32_t parse_8_digits(std::uint64_t chunk)
+        {
+            chunk = (chunk & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+            chunk = (chunk & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+            return std::uint32_t((chunk & 0x0000FFFF0000FFFF) * 42949672960001 >> 32);
+        }
+
+#ifdef CMD_SIMD_SSE41
+        // parses the 16 digits at p into x, returns false if they aren't all digits
+        inline bool parse_16_digits(const char* p, std::uint64_t& x)
+        {
+            auto v = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)p), _mm_set1_epi8('0'));
+            // bytes that were below '0' wrapped around above 9
+            auto ok = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(9)), _mm_set1_epi8(9));
+            if(_mm_movemask_epi8(ok) != 0xFFFF)
+                return false;
+            // pairs of digits, then 4 digits, then 8 digits
+            auto v2 = _mm_maddubs_epi16(v, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                                         10, 1, 10, 1));
+            auto v4 = _mm_madd_epi16(v2, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+            auto v8 = _mm_madd_epi16(_mm_packus_epi32(v4, v4),
+                                     _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+            x = std::uint64_t(std::uint32_t(_mm_cvtsi128_si32(v8))) * 100000000 +
+                std::uint32_t(_mm_extract_epi32(v8, 1));
+            return true;
+        }
+#endif
+
+        // appends the digits from p to x, which wraps around past 64 bits, returns the end of the
+        // digits. Digits are read 8 at a time within a 64-bit integer on little-endian machines,
+        // then 16 at a time with SSE4.1 where available once 8 were, the rest one at a time.
+        inline const char* accumulate_digits(const char* p, const char* last, std::uint64_t& x)
+        {
+            if constexpr(std::endian::native == std::endian::little)
+            {
+                constexpr std::uint64_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000,
+                                                   10000000, 100000000};
+                while(last - p >= 8)
+                {
+                    std::uint64_t chunk;
+                    std::memcpy(&chunk, p, 8);
+                    auto n = leading_digits(chunk);
+                    // fewer digits are shifted to the end, behind zeros
+                    if(n > 0)
+                        x = x * pow10[n] + parse_8_digits(chunk << (64 - 8 * n));
+                    p += n;
+                    if(n < 8)
+                        return p;
+#ifdef CMD_SIMD_SSE41
+                    for(std::uint64_t v; last - p >= 16 && parse_16_digits(p, v); p += 16)
+                        x = x * 10000000000000000 + v;
+#endif
+                }
+            }
+            for(; p != last && unsigned(*p - '0') < 10; p++)
+                x = x * 10 + unsigned(*p - '0');
+            return p;
+        }
+
+        // integers are parsed by parse_integer, with the semantics of std::from_chars in base 10
+        template <typename T>
+        constexpr bool fast_integer = std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                      sizeof(T) <= sizeof(std::uint64_t);
+
+        // std::from_chars in base 10 for integers of up to 64 bits, see accumulate_digits
+        template <typename T>
+        inline std::from_chars_result parse_integer(const char* first, const char* last, T& value)
+        {
+            auto p = first;
+            bool neg = false;
+            if constexpr(std::is_signed_v<T>)
+            {
+                if(p != last && *p == '-')
+                {
+                    neg = true;
+                    p++;
+                }
+            }
+
+            // the value wraps around past 64 bits, which is told from the number of digits
+            auto digits = p;
+            std::uint64_t x = 0;
+            p = accumulate_digits(p, last, x);
+            if(p == digits)
+                return {first, std::errc::invalid_argument};
+
+            // 20 digits fit only from 10^19 to 2^64 - 1, which starts with 1 and wraps around
+            // below 10^19 past it. Leading zeros are only skipped past 19 digits, below which
+            // nothing wraps around.
+            bool overflow = false;
+            if(p - digits > 19)
+            {
+                while(digits != p && *digits == '0')
+                    digits++;
+                auto n = p - digits;
+                overflow = n > 20 || (n == 20 && (*digits != '1' || x < 10000000000000000000u));
+            }
+
+            using U = std::make_unsigned_t<T>;
+            auto max = std::uint64_t(std::numeric_limits<T>::max()) + neg;
+            if(overflow || x > max)
+                return {p, std::errc::result_out_of_range};
+            value = T(neg ? U(0) - U(x) : U(x));
+            return {p, std::errc{}};
+        }
+
+        // a fixed-size unsigned integer, for the exact steps of parsing floating types.
+        // Operations only go through the limbs in use, a few for most numbers parsed.
+        template <size_t N>
+        struct big_uint
+        {
+            std::uint32_t limbs[N] = {}; // the least significant first
+            size_t size = 0;             // the limbs from size on are zeros
+
+            constexpr big_uint() = default;
+            constexpr explicit big_uint(std::uint64_t x)
+                : limbs{std::uint32_t(x), std::uint32_t(x >> 32)}, size{2}
+            {
+            }
+
+            static constexpr big_uint power_of_two(int n)
+            {
+                big_uint x;
+                x.limbs[n / 32] = std::uint32_t(1) << n % 32;
+                x.size = size_t(n / 32 + 1);
+                return x;
+            }
+
+            constexpr void multiply(std::uint32_t m)
+            {
+                std::uint64_t carry = 0;
+                for(size_t i = 0; i < size; i++)
+                {
+                    carry += std::uint64_t(limbs[i]) * m;
+                    limbs[i] = std::uint32_t(carry);
+                    carry >>= 32;
+                }
+                if(carry != 0 && size < N)
+                    limbs[size++] = std::uint32_t(carry);
+            }
+
+            constexpr void add(std::uint32_t a)
+            {
+                size_t i = 0;
+                for(; a != 0 && i < N; i++)
+                {
+                    auto s = std::uint64_t(limbs[i]) + a;
+                    limbs[i] = std::uint32_t(s);
+                    a = std::uint32_t(s >> 32);
+                }
+                size = (std::max)(size, i);
+            }
+
+            constexpr void divide(std::uint32_t d)
+            {
+                std::uint64_t r = 0;
+                for(size_t i = size; i-- > 0;)
+                {
+                    r = r << 32 | limbs[i];
+                    limbs[i] = std::uint32_t(r / d);
+                    r %= d;
+                }
+            }
+
+            constexpr void shift_left(int n)
+            {
+                size = (std::min)(N, size + size_t((n + 31) / 32));
+                for(size_t i = size; i-- > 0;)
+                    limbs[i] = std::uint32_t(bits(int(32 * i) - n));
+            }
+
+            constexpr void shift_right(int n)
+            {
+                for(size_t i = 0; i < size; i++)
+                    limbs[i] = std::uint32_t(bits(int(32 * i) + n));
+            }
+
+            constexpr int bit_width() const
+            {
+                for(size_t i = size; i-- > 0;)
+                    if(limbs[i] != 0)
+                        return int(32 * i) + std::bit_width(limbs[i]);
+                return 0;
+            }
+
+            // the 64 bits from bit s up, bits outside the integer are zeros
+            constexpr std::uint64_t bits(int s) const
+            {
+                auto limb = [&](int i) -> std::uint64_t {
+                    return i >= 0 && i < int(N) ? limbs[i] : 0;
+                };
+                int i = (s >= 0 ? s : s - 31) / 32;
+                int r = s - 32 * i;
+                auto w = (limb(i) | limb(i + 1) << 32) >> r;
+                return r == 0 ? w : w | limb(i + 2) << (64 - r);
+            }
+
+            friend constexpr std::strong_ordering operator<=>(const big_uint& a, const big_uint& b)
+            {
+                for(size_t i = (std::max)(a.size, b.size); i-- > 0;)
+                    if(a.limbs[i] != b.limbs[i])
+                        return a.limbs[i] <=> b.limbs[i];
+                return std::strong_ordering::equal;
+            }
+        };
+
+        // Eisel-Lemire multiplies by 128-bit approximations of 5^q from 5^-342 to 5^308, the
+        // upper 64 bits first. As in fast_float, positive powers are truncated and negative ones
+        // are rounded up from floor(2^b / 5^-q), with b as large as its proof of exactness needs.
+        inline constexpr int min_power5 = -342;
+        inline constexpr int max_power5 = 308;
+
+        constexpr auto make_powers_of_five()
+        {
+            std::array<std::uint64_t, 2 * (max_power5 - min_power5 + 1)> table{};
+            constexpr int b_max = 1728; // at least twice the width of 5^342 plus 128
+            auto r = big_uint<b_max / 32 + 1>::power_of_two(b_max); // floor(2^b_max / 5^n)
+            big_uint<26> p{1};                                      // 5^n
+            for(int n = 0; n <= -min_power5; n++)
+            {
+                if(n <= max_power5)
+                {
+                    int w = p.bit_width();
+                    table[2 * (n - min_power5)] = p.bits(w - 64);
+                    table[2 * (n - min_power5) + 1] = p.bits(w - 128);
+                }
+                if(n > 0)
+                {
+                    r.divide(5);
+                    int z = p.bit_width();
+                    auto c = r;
+                    c.shift_right(b_max - (n <= 27 ? z + 127 : 2 * z + 128));
+                    c.add(1);
+                    int w = c.bit_width();
+                    table[2 * (-n - min_power5)] = c.bits(w - 64);
+                    table[2 * (-n - min_power5) + 1] = c.bits(w - 128);
+                }
+                p.multiply(5);
+            }
+            return table;
+        }
+
+        // a template so that only programs parsing floating types compute it
+        template <typename = void>
+        inline constexpr auto powers_of_five = make_powers_of_five();
+
+        // the 128-bit product of a and b as {high, low}
+        inline std::pair<std::uint64_t, std::uint64_t> multiply_128(std::uint64_t a,
+                                                                    std::uint64_t b)
+        {
+#ifdef __SIZEOF_INT128__
+            __extension__ using u128 = unsigned __int128;
+            auto x = u128(a) * b;
+            return {std::uint64_t(x >> 64), std::uint64_t(x)};
+#else
+            std::uint64_t al = std::uint32_t(a), ah = a >> 32;
+            std::uint64_t bl = std::uint32_t(b), bh = b >> 32;
+            auto ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+            auto mid = (ll >> 32) + std::uint32_t(lh) + std::uint32_t(hl);
+            return {hh + (lh >> 32) + (hl >> 32) + (mid >> 32), mid << 32 | std::uint32_t(ll)};
+#endif
+        }
+
+        // the binary formats of the floating types parsed by parse_float
+        template <typename T>
+        struct float_format;
+
+        template <>
+        struct float_format<double>
+        {
+            using bits = std::uint64_t;
+            static constexpr int mantissa_bits = 52;
+            static constexpr int min_exponent = -1023;
+            static constexpr int infinite_power = 0x7FF;
+            // decimal exponents past which 19 digits are always 0 or infinity
+            static constexpr int min_power10 = -342;
+            static constexpr int max_power10 = 308;
+            static constexpr int min_round_to_even = -4;
+            static constexpr int max_round_to_even = 23;
+            // the exact mantissas and powers of ten
+            static constexpr std::uint64_t max_exact = std::uint64_t(1) << 53;
+            static constexpr double powers10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                                  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                                  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        };
+
+        template <>
+        struct float_format<float>
+        {
+            using bits = std::uint32_t;
+            static constexpr int mantissa_bits = 23;
+            static constexpr int min_exponent = -127;
+            static constexpr int infinite_power = 0xFF;
+            static constexpr int min_power10 = -64;
+            static constexpr int max_power10 = 38;
+            static constexpr int min_round_to_even = -17;
+            static constexpr int max_round_to_even = 10;
+            static constexpr std::uint64_t max_exact = std::uint64_t(1) << 24;
+            static constexpr float powers10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f,  1e5f,
+                                                 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+        };
+
+        // a binary floating value before its sign, with the biased exponent in power2 and the
+        // mantissa without its implicit bit
+        struct binary_float
+        {
+            std::uint64_t mantissa = 0;
+            int power2 = 0;
+
+            bool operator==(const binary_float&) const = default;
+        };
+
+        // Eisel-Lemire: w * 10^q rounded to nearest, even on ties, for w of at most 19 digits
+        template <typename T>
+        inline binary_float compute_float(std::int64_t q, std::uint64_t w)
+        {
+            using F = float_format<T>;
+            if(w == 0 || q < F::min_power10)
+                return {};
+            if(q > F::max_power10)
+                return {0, F::infinite_power};
+
+            int lz = std::countl_zero(w);
+            w <<= lz;
+            auto& table = powers_of_five<>;
+            auto i = size_t(2 * (q - min_power5));
+            auto [high, low] = multiply_128(w, table[i]);
+            // the lower bits are refined only when they may carry into the mantissa
+            constexpr auto mask = ~std::uint64_t(0) >> (F::mantissa_bits + 3);
+            if((high & mask) == mask)
+            {
+                auto second = multiply_128(w, table[i + 1]).first;
+                low += second;
+                high += second > low;
+            }
+
+            int upper = int(high >> 63);
+            int shift = upper + 64 - F::mantissa_bits - 3;
+            binary_float x;
+            x.mantissa = high >> shift;
+            // floor(log2(10^q)) + 63 with the binary exponent of 5^q
+            int power = int((217706 * q) >> 16) + 63;
+            x.power2 = power + upper - lz - F::min_exponent;
+            if(x.power2 <= 0)
+            {
+                // subnormal
+                if(-x.power2 + 1 >= 64)
+                    return {};
+                x.mantissa >>= -x.power2 + 1;
+                x.mantissa += x.mantissa & 1;
+                x.mantissa >>= 1;
+                // rounding up may reach the smallest normal
+                x.power2 = x.mantissa < (std::uint64_t(1) << F::mantissa_bits) ? 0 : 1;
+                return x;
+            }
+
+            // exact halfway points round down to even, they only exist for small q
+            if(low <= 1 && q >= F::min_round_to_even && q <= F::max_round_to_even &&
+               (x.mantissa & 3) == 1 && (x.mantissa << shift) == high)
+                x.mantissa &= ~std::uint64_t(1);
+            x.mantissa += x.mantissa & 1;
+            x.mantissa >>= 1;
+            if(x.mantissa >= (std::uint64_t(2) << F::mantissa_bits))
+            {
+                x.mantissa = std::uint64_t(1) << F::mantissa_bits;
+                x.power2++;
+            }
+            x.mantissa &= ~(std::uint64_t(1) << F::mantissa_bits);
+            if(x.power2 >= F::infinite_power)
+                return {0, F::infinite_power};
+            return x;
+        }
+
+        // a decimal number mantissa * 10^exponent, with the first 19 significant digits in
+        // mantissa and the digits where they lie
+        struct decimal
+        {
+            std::uint64_t mantissa = 0;
+            std::int64_t exponent = 0;
+            bool negative = false;
+            bool truncated = false;
+            const char* integer = nullptr;
+            const char* integer_end = nullptr;
+            const char* fraction = nullptr;
+            const char* fraction_end = nullptr;
+            std::int64_t exp_number = 0; // the written exponent
+        };
+
+        // the one of a and its successor b closest to a decimal of more than 19 digits, which
+        // compute_float can't tell apart. The digits are compared exactly with the halfway point.
+        template <typename T>
+        inline binary_float round_exactly(const decimal& d, binary_float a, binary_float b)
+        {
+            using F = float_format<T>;
+            // the halfway point is (2m + 1) * 2^(e - 1)
+            auto m = a.mantissa;
+            int e = 1 + F::min_exponent - F::mantissa_bits;
+            if(a.power2 > 0)
+            {
+                m |= std::uint64_t(1) << F::mantissa_bits;
+                e = a.power2 + F::min_exponent - F::mantissa_bits;
+            }
+
+            // halfway points have at most 767 significant digits, more only tell if it's exact
+            constexpr int max_digits = 800;
+            big_uint<128> digits;
+            int n = 0;
+            bool sticky = false;
+            std::int64_t k = d.exp_number + (d.integer_end - d.integer);
+            // digits are added 9 at a time
+            std::uint32_t chunk = 0, scale = 1;
+            auto flush = [&] {
+                digits.multiply(scale);
+                digits.add(chunk);
+                chunk = 0;
+                scale = 1;
+            };
+            auto take = [&](const char* p, const char* end) {
+                for(; p != end; p++)
+                {
+                    if(n == max_digits)
+                        sticky |= *p != '0';
+                    else
+                    {
+                        chunk = chunk * 10 + std::uint32_t(*p - '0');
+                        scale *= 10;
+                        if(scale == 1000000000)
+                            flush();
+                        n += n > 0 || *p != '0';
+                        k--;
+                    }
+                }
+            };
+            take(d.integer, d.integer_end);
+            take(d.fraction, d.fraction_end);
+            flush();
+
+            // compare digits * 5^k * 2^k with (2m + 1) * 2^(e - 1), both sides are close to it
+            big_uint<128> half{2 * m + 1};
+            constexpr std::uint32_t pow5[] = {1,       5,        25,        125,       625,
+                                              3125,    15625,    78125,     390625,    1953125,
+                                              9765625, 48828125, 244140625, 1220703125};
+            auto& five = k < 0 ? half : digits;
+            for(auto i = k < 0 ? -k : k; i > 0; i -= 13)
+                five.multiply(pow5[std::min<std::int64_t>(i, 13)]);
+            auto two = k - (e - 1);
+            if(two > 0)
+                digits.shift_left(int(two));
+            else
+                half.shift_left(int(-two));
+
+            auto cmp = digits <=> half;
+            if(cmp > 0 || (cmp == 0 && sticky))
+                return b;
+            if(cmp < 0)
+                return a;
+            return (a.mantissa & 1) == 0 ? a : b;
+        }
+
+        // the infinities and NaNs of std::from_chars: inf, infinity, nan and nan(chars) in any
+        // case, optionally negative
+        template <typename T>
+        inline std::from_chars_result parse_special(const char* first, const char* last, T& value)
+        {
+            auto p = first;
+            bool neg = p != last && *p == '-';
+            p += neg;
+            auto match = [&](std::string_view word) {
+                if(size_t(last - p) < word.size())
+                    return false;
+                for(size_t i = 0; i < word.size(); i++)
+                    if((p[i] | 0x20) != word[i])
+                        return false;
+                p += word.size();
+                return true;
+            };
+
+            if(match("nan"))
+            {
+                if(p != last && *p == '(')
+                {
+                    for(auto q = p + 1; q != last; q++)
+                    {
+                        if(*q == ')')
+                        {
+                            p = q + 1;
+                            break;
+                        }
+                        if(unsigned((*q | 0x20) - 'a') >= 26 && unsigned(*q - '0') >= 10 &&
+                           *q != '_')
+                            break;
+                    }
+                }
+                value = neg ? -std::numeric_limits<T>::quiet_NaN()
+                            : std::numeric_limits<T>::quiet_NaN();
+                return {p, std::errc{}};
+            }
+            if(match("inf"))
+            {
+                match("inity");
+                value = neg ? -std::numeric_limits<T>::infinity()
+                            : std::numeric_limits<T>::infinity();
+                return {p, std::errc{}};
+            }
+            return {first, std::errc::invalid_argument};
+        }
+
+        // std::from_chars in the general format for float and double, after fast_float.
+        // Mantissas of up to 19 digits are read like integers, see accumulate_digits. Exact
+        // products are computed directly, the rest by Eisel-Lemire, which is only unsure when
+        // digits past the 19th sit near a halfway point.
+        template <typename T>
+        inline std::from_chars_result parse_float(const char* first, const char* last, T& value)
+        {
+            using F = float_format<T>;
+            decimal d;
+            auto p = first;
+            if(p != last && *p == '-')
+            {
+                d.negative = true;
+                p++;
+            }
+
+            d.integer = p;
+            p = accumulate_digits(p, last, d.mantissa);
+            d.integer_end = d.fraction = d.fraction_end = p;
+            if(p != last && *p == '.')
+            {
+                d.fraction = ++p;
+                p = accumulate_digits(p, last, d.mantissa);
+                d.fraction_end = p;
+            }
+            auto n = (d.integer_end - d.integer) + (d.fraction_end - d.fraction);
+            if(n == 0)
+                return parse_special(first, last, value);
+
+            // an exponent without digits isn't part of the number
+            if(p != last && (*p | 0x20) == 'e')
+            {
+                auto q = p + 1;
+                bool neg = q != last && *q == '-';
+                q += q != last && (*q == '-' || *q == '+');
+                if(q != last && unsigned(*q - '0') < 10)
+                {
+                    // saturated far beyond any finite nonzero value
+                    for(; q != last && unsigned(*q - '0') < 10; q++)
+                        if(d.exp_number < 0x10000000)
+                            d.exp_number = d.exp_number * 10 + (*q - '0');
+                    if(neg)
+                        d.exp_number = -d.exp_number;
+                    p = q;
+                }
+            }
+            d.exponent = d.exp_number - (d.fraction_end - d.fraction);
+
+            if(n > 19)
+            {
+                for(auto q = d.integer; q != d.fraction_end && (*q == '0' || *q == '.'); q++)
+                    n -= *q == '0';
+                if(n > 19)
+                {
+                    // keep the first 19 significant digits
+                    d.truncated = true;
+                    d.mantissa = 0;
+                    auto q = d.integer;
+                    for(; d.mantissa < 1000000000000000000 && q != d.integer_end; q++)
+                        d.mantissa = d.mantissa * 10 + unsigned(*q - '0');
+                    d.exponent = d.exp_number + (d.integer_end - q);
+                    if(d.mantissa < 1000000000000000000)
+                    {
+                        for(q = d.fraction; d.mantissa < 1000000000000000000 &&
+                                            q != d.fraction_end;
+                            q++)
+                            d.mantissa = d.mantissa * 10 + unsigned(*q - '0');
+                        d.exponent = d.exp_number - (q - d.fraction);
+                    }
+                }
+            }
+
+            // products of exact values are rounded exactly, unless in excess precision
+            if(FLT_EVAL_METHOD == 0 && !d.truncated && d.mantissa <= F::max_exact &&
+               d.exponent >= -std::ssize(F::powers10) + 1 && d.exponent < std::ssize(F::powers10))
+            {
+                auto x = T(d.mantissa);
+                x = d.exponent < 0 ? x / F::powers10[-d.exponent] : x * F::powers10[d.exponent];
+                value = d.negative ? -x : x;
+                return {p, std::errc{}};
+            }
+
+            auto x = compute_float<T>(d.exponent, d.mantissa);
+            if(d.truncated)
+            {
+                auto next = compute_float<T>(d.exponent, d.mantissa + 1);
+                if(x != next)
+                    x = round_exactly<T>(d, x, next);
+            }
+            if((d.mantissa != 0 && x == binary_float{}) || x.power2 == F::infinite_power)
+                return {p, std::errc::result_out_of_range};
+
+            using B = typename F::bits;
+            value = std::bit_cast<T>(B(x.mantissa) | B(x.power2) << F::mantissa_bits |
+                                     B(d.negative) << (8 * sizeof(B) - 1));
+            return {p, std::errc{}};
+        }
+
+        // floating types are parsed by parse_float, long double only when it is double
+        template <typename T>
+        constexpr bool fast_floating =
+            std::is_same_v<T, float> || std::is_same_v<T, double> ||
+            (std::is_same_v<T, long double> && std::numeric_limits<long double>::digits == 53 &&
+             std::numeric_limits<long double>::max_exponent == 1024);
+
+        // std::from_chars, faster for integers and floats and without needing the standard
+        // library to implement it for floating types
+        template <typename T>
+        requires fast_integer<T> || fast_floating<T> || requires(const char* p, T& x)
+        {
+            std::from_chars(p, p, x);
+        }
+        inline std::from_chars_result from_chars(const char* first, const char* last, T& value)
+        {
+            if constexpr(fast_integer<T>)
+                return parse_integer(first, last, value);
+            else if constexpr(std::is_same_v<T, long double> && fast_floating<T>)
+            {
+                double x;
+                auto res = parse_float(first, last, x);
+                if(res.ec == std::errc{})
+                    value = x;
+                return res;
+            }
+            else if constexpr(fast_floating<T>)
+                return parse_float(first, last, value);
+            else
+                return std::from_chars(first, last, value);
+        }
+    } // namespace detail
+
+    // Integral types up to 64 bits and float and double are parsed by cmd itself, other
+    // arithmetic types such as an extended long double by std::from_chars.
+    // The end of the number is checked against the end of the token as part of the parse.
+    template <typename T, parse_policy P>
+    requires requires(const char* p, T x)
+    {
+        detail::from_chars(p, p, x);
+    }
+    struct from_string<T, P>
+    {
+        std::optional<T> operator()(std::string_view tok)
+        {
+            T x = 0;
+            auto end = tok.data() + tok.size();
+            auto res = detail::from_chars(tok.data(), end, x);
+            if(res.ec != std::errc{} || (P == parse_policy::strict && res.ptr != end))
+                return {};
+            return x;
+        }
+
+        std::optional<T> operator()(const char*& first, const char* last)
+        {
+            T x = 0;
+            auto res = detail::from_chars(first, last, x);
+            if(res.ec != std::errc{})
+                return {};
+            first = res.ptr;
+            return x;
+        }
+    };
+
+    template <parse_policy P>
+    struct from_string<std::string_view, P>
+    {
+        std::optional<std::string_view> operator()(std::string_view tok) { return tok; }
+    };
+
+    template <parse_policy P>
+    struct from_string<std::string, P>
+    {
+        std::optional<std::string> operator()(std::string tok) { return tok; }
+        std::optional<std::string> operator()(std::string_view tok) { return std::string{tok}; }
+    };
+
+    // a sink is a buffer that results can be appended to, such as std::string or a socket's
+    // output buffer
+    template <typename S>
+    concept sink = requires(S& s, const char* p, size_t n)
+    {
+        s.append(p, n);
+    };
+
+    namespace detail
+    {
+        // Schubfach multiplies by 128-bit approximations of 10^k from 10^-292 to 10^326, the
+        // upper 64 bits first, scaled to 128 bits wide and rounded up
+        inline constexpr int min_power10 = -292;
+        inline constexpr int max_power10 = 326;
+
+        constexpr auto make_powers_of_ten()
+        {
+            std::array<std::uint64_t, 2 * (max_power10 - min_power10 + 1)> table{};
+            auto store = [&](int k, std::uint64_t high, std::uint64_t low, bool up) {
+                low += up;
+                table[2 * (k - min_power10)] = high + (up && low == 0);
+                table[2 * (k - min_power10) + 1] = low;
+            };
+            // 10^k has the bits of 5^k, 5^-n those of floor(2^b_max / 5^n), which are never exact
+            constexpr int b_max = 1024; // 5^292 is 679 bits wide, enough are left
+            auto r = big_uint<b_max / 32 + 1>::power_of_two(b_max);
+            big_uint<24> p{1};
+            for(int n = 0; n <= max_power10; n++)
+            {
+                int w = p.bit_width();
+                store(n, p.bits(w - 64), p.bits(w - 128), w > 128);
+                if(n > 0 && n <= -min_power10)
+                {
+                    r.divide(5);
+                    w = r.bit_width();
+                    store(-n, r.bits(w - 64), r.bits(w - 128), true);
+                }
+                p.multiply(5);
+            }
+            return table;
+        }
+
+        // a template so that only programs formatting floating types compute it
+        template <typename = void>
+        inline constexpr auto powers_of_ten = make_powers_of_ten();
+
+        // digits * 10^exponent
+        struct decimal_float
+        {
+            std::uint64_t digits;
+            int exponent;
+        };
+
+        // the shortest decimal that rounds to the positive finite x, the closest to it if there
+        // are several, by Schubfach. It may end with zeros.
+        template <typename T>
+        inline decimal_float shortest_decimal(T x)
+        {
+            using F = float_format<T>;
+            auto bits = std::uint64_t(std::bit_cast<typename F::bits>(x));
+            auto m = bits & ((std::uint64_t(1) << F::mantissa_bits) - 1);
+            int e = int(bits >> F::mantissa_bits);
+            // x is c * 2^q
+            std::uint64_t c = m;
+            int q = 1 + F::min_exponent - F::mantissa_bits;
+            if(e != 0)
+            {
+                c |= std::uint64_t(1) << F::mantissa_bits;
+                q = e + F::min_exponent - F::mantissa_bits;
+                // integers are exact
+                if(q <= 0 && -q <= F::mantissa_bits && (c & ((std::uint64_t(1) << -q) - 1)) == 0)
+                    return {c >> -q, 0};
+            }
+
+            // the rounding interval, 4 times as large, its bounds included if c is even
+            bool even = c % 2 == 0;
+            bool closer = m == 0 && e > 1; // the lower bound is half as far
+            auto cbl = 4 * c - 2 + closer, cb = 4 * c, cbr = 4 * c + 2;
+            // floor(log10(2^q)), or of 3/4 * 2^q, and floor(log2(10^-k))
+            int k = (q * 1262611 - (closer ? 524031 : 0)) >> 22;
+            int h = q + ((-k * 1741647) >> 19) + 1;
+
+            // the upper bits of g * cp, with the lowest bit set if any lower one is
+            auto& table = powers_of_ten<>;
+            auto i = size_t(2 * (-k - min_power10));
+            auto round_to_odd = [&](std::uint64_t cp) {
+                auto x1 = multiply_128(table[i + 1], cp).first;
+                auto [y1, y0] = multiply_128(table[i], cp);
+                auto z = y0 + x1;
+                return (y1 + (z < y0)) | (z > 1);
+            };
+            auto vbl = round_to_odd(cbl << h);
+            auto vb = round_to_odd(cb << h);
+            auto vbr = round_to_odd(cbr << h);
+            auto lower = vbl + !even, upper = vbr - !even;
+
+            // one digit less, if only one of its neighbors is in the interval
+            auto s = vb / 4;
+            if(s >= 10)
+            {
+                auto sp = s / 10;
+                bool up_inside = lower <= 40 * sp;
+                bool wp_inside = 40 * sp + 40 <= upper;
+                if(up_inside != wp_inside)
+                    return {sp + wp_inside, k + 1};
+            }
+            bool u_inside = lower <= 4 * s;
+            bool w_inside = 4 * s + 4 <= upper;
+            if(u_inside != w_inside)
+                return {s + w_inside, k};
+            // both are, the closest one, even on ties
+            auto mid = 4 * s + 2;
+            return {s + (vb > mid || (vb == mid && (s & 1) != 0)), k};
+        }
+
+        inline constexpr auto digit_pairs = [] {
+            std::array<char, 200> pairs{};
+            for(int i = 0; i < 100; i++)
+            {
+                pairs[2 * i] = char('0' + i / 10);
+                pairs[2 * i + 1] = char('0' + i % 10);
+            }
+            return pairs;
+        }();
+
+        // the number of decimal digits of x, 1 for 0
+        inline int count_digits(std::uint64_t x)
+        {
+            constexpr std::uint64_t pow10[] = {1,
+                                               10,
+                                               100,
+                                               1000,
+                                               10000,
+                                               100000,
+                                               1000000,
+                                               10000000,
+                                               100000000,
+                                               1000000000,
+                                               10000000000,
+                                               100000000000,
+                                               1000000000000,
+                                               10000000000000,
+                                               100000000000000,
+                                               1000000000000000,
+                                               10000000000000000,
+                                               100000000000000000,
+                                               1000000000000000000,
+                                               10000000000000000000u};
+            // powers of ten are even, x | 1 has as many digits
+            x |= 1;
+            int n = std::bit_width(x) * 1233 >> 12;
+            return n + (x >= pow10[n]);
+        }
+
+        // writes the last n digits of x ending at last, in blocks of 8 split into pairs, which
+        // only need 32-bit arithmetic
+        inline void write_digits(char* last, std::uint64_t x, int n)
+        {
+            for(; n >= 8; n -= 8)
+            {
+                auto block = std::uint32_t(x % 100000000);
+                x /= 100000000;
+                auto high = block / 10000, low = block % 10000;
+                last -= 8;
+                std::memcpy(last, &digit_pairs[2 * (high / 100)], 2);
+                std::memcpy(last + 2, &digit_pairs[2 * (high % 100)], 2);
+                std::memcpy(last + 4, &digit_pairs[2 * (low / 100)], 2);
+                std::memcpy(last + 6, &digit_pairs[2 * (low % 100)], 2);
+            }
+            auto y = std::uint32_t(x);
+            for(; n >= 2; n -= 2)
+            {
+                last -= 2;
+                std::memcpy(last, &digit_pairs[2 * (y % 100)], 2);
+                y /= 100;
+            }
+            if(n > 0)
+                *--last = char('0' + y % 10);
+        }
+
+        // the number of decimal digits of the largest finite magnitudes
+        constexpr int count_digits_of(int x)
+        {
+            int n = 1;
+            for(; x >= 10; x /= 10)
+                n++;
+            return n;
+        }
+
+        // the most characters std::to_chars writes for x of type T, with fmt and precision if
+        // they are given and precision isn't negative. Exponents take at least 2 digits.
+        template <typename T>
+        constexpr size_t max_chars(std::optional<std::chars_format> fmt = {}, int precision = -1)
+        {
+            if constexpr(!std::is_floating_point_v<T>)
+                return size_t(8 * sizeof(T) * 1233 >> 12) + 1 + (T(-1) < T(0));
+            else
+            {
+                using L = std::numeric_limits<T>;
+                size_t exp10 = std::max(2, count_digits_of(L::max_digits10 - L::min_exponent10));
+                size_t exp2 = count_digits_of(L::digits - L::min_exponent);
+                size_t digits = precision >= 0 ? size_t(precision) : L::max_digits10 - 1;
+                // -d.ddde+xx, and -inf and -nan fit
+                size_t scientific = 5 + digits + exp10;
+                if(!fmt || *fmt == std::chars_format::scientific)
+                    return scientific;
+                if(*fmt == std::chars_format::hex)
+                {
+                    size_t nibbles = precision >= 0 ? size_t(precision) : (L::digits + 2) / 4;
+                    return 5 + nibbles + exp2;
+                }
+                if(*fmt == std::chars_format::general)
+                    // -0.000ddd before switching to scientific
+                    return std::max(scientific, 7 + digits);
+                // the integer digits of the largest, the fraction digits of the smallest
+                size_t integer = 1 + size_t(L::max_exponent10);
+                size_t fraction = precision >= 0 ? size_t(precision)
+                                                 : L::max_digits10 - size_t(L::min_exponent10);
+                return 2 + integer + fraction;
+            }
+        }
+
+        // the characters of x written by std::to_chars(first, last, x), or with fmt and precision
+        // unless it's negative, computed before they are written so that they go straight into
+        // their destination. size() is exact, or an upper bound where write defers to
+        // std::to_chars: for long double, a precision and exact integers past 64 bits.
+        // Otherwise, the shortest digits come from shortest_decimal.
+        template <typename T>
+        class float_chars
+        {
+          public:
+            // the most characters without a format or precision
+            static constexpr size_t max_size = max_chars<T>();
+
+            explicit float_chars(T x, std::optional<std::chars_format> fmt = {}, int precision = -1)
+                : x{x}, fmt{fmt}, precision{precision}
+            {
+                if constexpr(fast_floating<T>)
+                    if(precision < 0)
+                        prepare(F(x));
+                if(how == layout::to_chars)
+                    n = max_chars<T>(fmt, precision);
+            }
+
+            size_t size() const noexcept { return n; }
+
+            char* write(char* p) const
+            {
+                if(how == layout::to_chars)
+                {
+                    auto last = p + n;
+                    if(!fmt)
+                        return std::to_chars(p, last, x).ptr;
+                    if(precision < 0)
+                        return std::to_chars(p, last, x, *fmt).ptr;
+                    return std::to_chars(p, last, x, *fmt, precision).ptr;
+                }
+
+                if(neg)
+                    *p++ = '-';
+                switch(how)
+                {
+                case layout::special:
+                    std::memcpy(p, digits ? "nan" : "inf", 3);
+                    return p + 3;
+                case layout::scientific:
+                    // the first digit is moved before the point
+                    write_digits(p + 1 + count, digits, count);
+                    p[0] = p[1];
+                    if(count > 1)
+                        p[1] = '.';
+                    return write_exponent(p + count + (count > 1), exponent);
+                case layout::integer:
+                    write_digits(p + count, digits, count);
+                    return p + count;
+                case layout::hex:
+                {
+                    *p++ = lead;
+                    if(count > 0)
+                    {
+                        *p++ = '.';
+                        auto nibbles = digits;
+                        for(int i = count; i-- > 0; nibbles >>= 4)
+                            p[i] = "0123456789abcdef"[nibbles & 0xF];
+                        p += count;
+                    }
+                    *p++ = 'p';
+                    *p++ = exponent < 0 ? '-' : '+';
+                    auto e = std::uint64_t(exponent < 0 ? -exponent : exponent);
+                    int w = count_digits(e);
+                    write_digits(p + w, e, w);
+                    return p + w;
+                }
+                default:
+                    break;
+                }
+
+                // fixed, the digits are followed by zeros, split by the point or preceded by zeros
+                int k = exponent - count + 1;
+                if(k >= 0)
+                {
+                    write_digits(p + count, digits, count);
+                    std::memset(p + count, '0', size_t(k));
+                    return p + count + k;
+                }
+                if(exponent >= 0)
+                {
+                    write_digits(p + 1 + count, digits, count);
+                    std::memmove(p, p + 1, size_t(exponent + 1));
+                    p[exponent + 1] = '.';
+                    return p + 1 + count;
+                }
+                auto zeros = size_t(-exponent - 1);
+                std::memcpy(p, "0.", 2);
+                std::memset(p + 2, '0', zeros);
+                write_digits(p + 2 + zeros + count, digits, count);
+                return p + 2 + zeros + count;
+            }
+
+          private:
+            // a long double that is double is formatted as double
+            using F = std::conditional_t<std::is_same_v<T, float>, float, double>;
+
+            enum class layout
+            {
+                to_chars,
+                special,
+                fixed,
+                scientific,
+                integer,
+                hex,
+            };
+
+            void prepare(F v)
+            {
+                using FF = float_format<F>;
+                auto bits = std::uint64_t(std::bit_cast<typename FF::bits>(v));
+                neg = bits >> (8 * sizeof(F) - 1);
+                auto m = bits & ((std::uint64_t(1) << FF::mantissa_bits) - 1);
+                int e = int(bits >> FF::mantissa_bits) & FF::infinite_power;
+                if(e == FF::infinite_power)
+                {
+                    how = layout::special;
+                    digits = m != 0;
+                    n = neg + 3;
+                    return;
+                }
+
+                if(fmt == std::chars_format::hex)
+                {
+                    // the mantissa in whole nibbles after the leading digit, without trailing zeros
+                    constexpr int nibbles = (FF::mantissa_bits + 3) / 4;
+                    how = layout::hex;
+                    lead = e != 0 ? '1' : '0';
+                    digits = m << (4 * nibbles - FF::mantissa_bits);
+                    count = nibbles;
+                    for(; count > 0 && (digits & 0xF) == 0; count--)
+                        digits >>= 4;
+                    exponent = e != 0 ? e + FF::min_exponent : m != 0 ? 1 + FF::min_exponent : 0;
+                    auto w = count_digits(std::uint64_t(exponent < 0 ? -exponent : exponent));
+                    n = neg + 1 + (count > 0) + count + 2 + w;
+                    return;
+                }
+
+                int k = 0;
+                if(m != 0 || e != 0)
+                {
+                    auto d = shortest_decimal(neg ? -v : v);
+                    for(; d.digits % 10 == 0; d.exponent++)
+                        d.digits /= 10;
+                    digits = d.digits;
+                    k = d.exponent;
+                    count = count_digits(digits);
+                }
+                exponent = count - 1 + k;
+
+                auto abs_exponent = exponent < 0 ? -exponent : exponent;
+                size_t scientific = neg + count + (count > 1) + 2 + (abs_exponent >= 100 ? 3 : 2);
+                size_t fixed = neg + count + (k >= 0 ? k : exponent >= 0 ? 1 : 1 - exponent);
+                // the shorter one, or as %g with its default precision of 6
+                bool is_fixed = fixed <= scientific;
+                if(fmt == std::chars_format::general)
+                    is_fixed = exponent >= -4 && exponent < 6;
+                else if(fmt)
+                    is_fixed = *fmt == std::chars_format::fixed;
+                if(!is_fixed)
+                {
+                    how = layout::scientific;
+                    n = scientific;
+                    return;
+                }
+
+                // integers past the exact ones are written exactly rather than padded with zeros
+                int q = e + FF::min_exponent - FF::mantissa_bits;
+                if(k > 0 && q > 0)
+                {
+                    if(q + FF::mantissa_bits + 1 > 64)
+                        return;
+                    how = layout::integer;
+                    digits = (m | std::uint64_t(1) << FF::mantissa_bits) << q;
+                    count = count_digits(digits);
+                    n = neg + count;
+                    return;
+                }
+                how = layout::fixed;
+                n = fixed;
+            }
+
+            // writes e+xx or e-xxx
+            static char* write_exponent(char* p, int e)
+            {
+                *p++ = 'e';
+                *p++ = e < 0 ? '-' : '+';
+                if(e < 0)
+                    e = -e;
+                if(e >= 100)
+                {
+                    *p++ = char('0' + e / 100);
+                    e %= 100;
+                }
+                std::memcpy(p, &digit_pairs[2 * e], 2);
+                return p + 2;
+            }
+
+            T x;
+            std::optional<std::chars_format> fmt;
+            int precision;
+            size_t n = 0;
+            layout how = layout::to_chars;
+            bool neg = false;
+            char lead = '0';
+            // the decimal digits and the exponent of the first, an integer, or hex nibbles and
+            // the binary exponent
+            std::uint64_t digits = 0;
+            int count = 1;
+            int exponent = 0;
+        };
+
+        // the characters of an integer, see float_chars. Integers of up to 64 bits are written
+        // by write_digits, wider ones by std::to_chars.
+        template <typename T>
+        class integer_chars
+        {
+          public:
+            static constexpr size_t max_size = max_chars<T>();
+
+            explicit integer_chars(T x) : x{x}, n{max_size}
+            {
+                if constexpr(fits)
+                {
+                    u = std::uint64_t(std::make_unsigned_t<T>(x));
+                    if constexpr(std::is_signed_v<T>)
+                    {
+                        neg = x < 0;
+                        if(neg)
+                            u = std::uint64_t(0) - std::uint64_t(std::int64_t(x));
+                    }
+                    n = size_t(count_digits(u)) + neg;
+                }
+            }
+
+            size_t size() const noexcept { return n; }
+
+            char* write(char* p) const
+            {
+                if constexpr(fits)
+                {
+                    if(neg)
+                        *p = '-';
+                    write_digits(p + n, u, int(n) - neg);
+                    return p + n;
+                }
+                else
+                    return std::to_chars(p, p + n, x).ptr;
+            }
+
+          private:
+            static constexpr bool fits = sizeof(T) <= sizeof(std::uint64_t);
+
+            T x;
+            size_t n;
+            std::uint64_t u = 0; // the magnitude of x if it fits
+            bool neg = false;
+        };
+
+        // chars, the characters of a number, written straight into a new string, within its
+        // own buffer if it is short
+        template <typename C>
+        inline std::string chars_string(const C& chars)
+        {
+            std::string str(chars.size(), '\0');
+            auto end = chars.write(str.data());
+            // the size is only an upper bound where writing defers to std::to_chars
+            if(end != str.data() + str.size())
+                str.resize(size_t(end - str.data()));
+            return str;
+        }
+
+        // appends chars, the characters of a number, to out. Other sinks than std::string are
+        // given the characters from a buffer of C::max_size, or from a string for longer ones,
+        // which only a format or precision makes.
+        template <typename C, sink S>
+        inline void append_chars(const C& chars, S& out)
+        {
+            if constexpr(std::is_same_v<S, std::string>)
+            {
+                auto size = out.size();
+                out.resize(size + chars.size());
+                out.resize(size_t(chars.write(out.data() + size) - out.data()));
+            }
+            else
+            {
+                char buf[C::max_size];
+                if(chars.size() <= sizeof(buf))
+                    out.append(buf, size_t(chars.write(buf) - buf));
+                else
+                {
+                    std::string str;
+                    append_chars(chars, str);
+                    out.append(str.data(), str.size());
+                }
+            }
+        }
+    } // namespace detail
+
+    // to_string is the customization point for converting the return type to std::string.
+    // to_string is already specialized for void, std::string, integral types and floating types.
+    // It may also append to sinks directly with
+    //      void operator()(T x, S& out);
+    template <typename T>
+    struct to_string;
+
+    template <>
+    struct to_string<void>
+    {
+    };
+
+    // Numbers are formatted like std::to_chars, straight into the string or sink, see
+    // detail::float_chars.
+    template <typename T>
+    requires requires(T& x, char* buf)
+    {
+        std::to_chars(buf, buf, x);
+    }
+    struct to_string<T>
+    {
+        std::string operator()(T x)
+        {
+            if constexpr(std::is_floating_point_v<T>)
+                return detail::chars_string(detail::float_chars<T>{x});
+            else
+                return detail::chars_string(detail::integer_chars<T>{x});
+        }
+
+        // appends to out, which doesn't allocate once out has grown to fit
+        template <sink S>
+        void operator()(T x, S& out)
+        {
+            if constexpr(std::is_floating_point_v<T>)
+                detail::append_chars(detail::float_chars<T>{x}, out);
+            else
+                detail::append_chars(detail::integer_chars<T>{x}, out);
+        }
+    };
+
+    // a floating value to_string formats like std::to_chars in format, with precision unless it
+    // is negative, otherwise with the shortest digits that round-trip
+    template <std::floating_point T>
+    struct formatted
+    {
+        T value;
+        std::chars_format format = std::chars_format::general;
+        int precision = -1;
+    };
+
+    template <typename T>
+    struct to_string<formatted<T>>
+    {
+        std::string operator()(formatted<T> x)
+        {
+            return detail::chars_string(detail::float_chars<T>{x.value, x.format, x.precision});
+        }
+
+        template <sink S>
+        void operator()(formatted<T> x, S& out)
+        {
+            detail::append_chars(detail::float_chars<T>{x.value, x.format, x.precision}, out);
+        }
+    };
+
+    template <>
+    struct to_string<std::string>
+    {
+        std::string operator()(std::string&& x) { return std::move(x); }
+    };
+
+    template <typename T>
+    concept from_stringable = requires(std::string_view s, from_string<std::remove_cvref_t<T>> fs)
+    {
+        bool(fs(s));
+        {
+            *fs(s)
+        }
+        ->std::convertible_to<std::remove_cvref_t<T>>;
+    };
+
+    template <typename T>
+    concept to_stringable = std::is_void_v<T> || requires(T x)
+    {
+        to_string<std::remove_cvref_t<T>>{}(std::move(x));
+    };
+
+    template <typename R, typename... Args>
+    concept stringable = (to_stringable<R> && ... && from_stringable<Args>);
+
+    namespace detail
+    {
+        // signature_of<F>::type is R(Args...) for a function pointer, a member function pointer
+        // or a class with a single non-template operator(), such as a lambda
+        template <typename F>
+        struct signature_of
+        {
+        };
+
+        template <typename R, typename... Args, bool NE>
+        struct signature_of<R (*)(Args...) noexcept(NE)>
+        {
+            using type = R(Args...);
+        };
+
+        template <typename C, typename R, typename... Args, bool NE>
+        struct signature_of<R (C::*)(Args...) noexcept(NE)>
+        {
+            using type = R(Args...);
+        };
+
+        template <typename C, typename R, typename... Args, bool NE>
+        struct signature_of<R (C::*)(Args...) const noexcept(NE)>
+        {
+            using type = R(Args...);
+        };
+
+        template <typename F>
+        requires requires { &F::operator(); }
+        struct signature_of<F> : signature_of<decltype(&F::operator())>
+        {
+        };
+
+        template <typename F>
+        using signature_t = typename signature_of<std::decay_t<F>>::type;
+
+        template <typename Sig>
+        constexpr bool stringable_signature = false;
+
+        template <typename R, typename... Args>
+        constexpr bool stringable_signature<R(Args...)> = stringable<R, Args...>;
+
+        template <typename F, typename Sig>
+        constexpr bool const_invocable = false;
+
+        template <typename F, typename R, typename... Args>
+        constexpr bool const_invocable<F, R(Args...)> = std::is_invocable_v<const F&, Args...>;
+    } // namespace detail
+
+    // a copyable callable whose signature can be deduced and whose arguments and result are
+    // convertible by from_string and to_string. It must be callable as const, since calls are
+    // const and may be concurrent, and since it's copied as the registry and prepared commands
+    // are, which would silently split any state it modifies. A mutable lambda isn't one.
+    template <typename F>
+    concept stringable_callable = requires
+    {
+        typename detail::signature_t<F>;
+    }
+    &&std::copy_constructible<std::decay_t<F>>&&
+        detail::stringable_signature<detail::signature_t<F>>&&
+            detail::const_invocable<std::decay_t<F>, detail::signature_t<F>>;
+
+    namespace detail
+    {
+        // appends x converted by to_string to out, directly if to_string supports it
+        template <typename T, sink S>
+        inline void append_to(T&& x, S& out)
+        {
+            using rT = std::remove_cvref_t<T>;
+            if constexpr(requires { to_string<rT>{}(std::forward<T>(x), out); })
+                to_string<rT>{}(std::forward<T>(x), out);
+            else if constexpr(std::is_same_v<S, std::string>)
+            {
+                if(out.empty())
+                    out = to_string<rT>{}(std::forward<T>(x));
+                else
+                    out += to_string<rT>{}(std::forward<T>(x));
+            }
+            else
+            {
+                auto str = to_string<rT>{}(std::forward<T>(x));
+                out.append(str.data(), str.size());
+            }
+        }
+
+        // sink_ref refers to any sink, to pass it through type erasure
+        class sink_ref
+        {
+          public:
+            template <sink S>
+            requires(!std::is_same_v<S, sink_ref>) sink_ref(S& s)
+                : obj{&s},
+                  append_fn{[](void* o, const char* p, size_t n) { ((S*)o)->append(p, n); }}
+            {
+            }
+
+            void append(const char* p, size_t n) { append_fn(obj, p, n); }
+
+          private:
+            void* obj;
+            void (*append_fn)(void*, const char*, size_t);
+        };
+    } // namespace detail
+
+    // token_list_view is a non-owning random-access range of std::string_view over the tokens
+    // of a token_list.
+    class token_list_view
+    {
+      public:
+        class iterator;
+
+        token_list_view() = default;
+        token_list_view(const char* bytes, std::span<const size_t> ends, size_t first)
+            : bytes{bytes}, ends{ends}, first{first}
+        {
+        }
+
+        size_t size() const { return ends.size(); }
+        bool empty() const { return ends.empty(); }
+
+        std::string_view operator[](size_t i) const
+        {
+            auto begin = i > 0 ? ends[i - 1] : first;
+            return {bytes + begin, ends[i] - begin};
+        }
+        std::string_view front() const { return (*this)[0]; }
+
+        iterator begin() const;
+        iterator end() const;
+
+        // the tokens [offset, offset + count)
+        token_list_view subspan(size_t offset, size_t count = std::dynamic_extent) const
+        {
+            auto sub = ends.subspan(offset, count);
+            return {bytes, sub, offset > 0 ? ends[offset - 1] : first};
+        }
+
+      private:
+        const char* bytes = nullptr;
+        std::span<const size_t> ends; // end offsets of the tokens in bytes
+        size_t first = 0;             // begin offset of the first token
+    };
+
+    class token_list_view::iterator
+    {
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::string_view;
+
+        iterator() = default;
+        iterator(token_list_view v, difference_type i) : v{v}, i{i} {}
+
+        std::string_view operator*() const { return v[i]; }
+        std::string_view operator[](difference_type n) const { return v[i + n]; }
+
+        iterator& operator++()
+        {
+            ++i;
+            return *this;
+        }
+        iterator operator++(int) { return {v, i++}; }
+        iterator& operator--()
+        {
+            --i;
+            return *this;
+        }
+        iterator operator--(int) { return {v, i--}; }
+        iterator& operator+=(difference_type n)
+        {
+            i += n;
+            return *this;
+        }
+        iterator& operator-=(difference_type n)
+        {
+            i -= n;
+            return *this;
+        }
+        friend iterator operator+(iterator it, difference_type n) { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(iterator a, iterator b) { return a.i - b.i; }
+        friend bool operator==(iterator a, iterator b) { return a.i == b.i; }
+        friend std::strong_ordering operator<=>(iterator a, iterator b) { return a.i <=> b.i; }
+
+      private:
+        token_list_view v;
+        difference_type i = 0;
+    };
+
+    inline token_list_view::iterator token_list_view::begin() const { return {*this, 0}; }
+    inline token_list_view::iterator token_list_view::end() const
+    {
+        return {*this, std::ptrdiff_t(size())};
+    }
+
+    // token_list stores tokens contiguously in a single buffer along with their end offsets,
+    // it is used as a random-access range of std::string_view. Clearing it keeps its capacity
+    // so it can be reused across lines without allocating.
+    class token_list
+    {
+      public:
+        // reserves for count tokens totalling size bytes
+        void reserve(size_t size, size_t count)
+        {
+            bytes.reserve(size);
+            ends.reserve(count);
+        }
+
+        void clear()
+        {
+            bytes.clear();
+            ends.clear();
+        }
+
+        void push_back(std::string_view tok)
+        {
+            bytes += tok;
+            ends.push_back(bytes.size());
+        }
+
+        size_t size() const { return ends.size(); }
+        bool empty() const { return ends.empty(); }
+        std::string_view operator[](size_t i) const { return view()[i]; }
+        std::string_view front() const { return view()[0]; }
+
+        token_list_view::iterator begin() const { return view().begin(); }
+        token_list_view::iterator end() const { return view().end(); }
+
+        // the view is invalidated by modifying the token_list
+        token_list_view view() const { return {bytes.data(), ends, 0}; }
+        operator token_list_view() const { return view(); }
+
+        token_list_view subspan(size_t offset, size_t count = std::dynamic_extent) const
+        {
+            return view().subspan(offset, count);
+        }
+
+      private:
+        friend char tokenize(std::string_view, token_list&);
+
+        std::string bytes;
+        std::vector<size_t> ends;
+        std::string scratch; // spliced tokens while tokenizing
+    };
+
+    namespace detail::simd
+    {
+#ifdef CMD_SIMD_X86
+        inline bool cpu_has_avx2()
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            if(info[0] < 7)
+                return false;
+            __cpuid(info, 1);
+            bool osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28);
+            if(!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+                return false;
+            __cpuidex(info, 7, 0);
+            return info[1] & (1 << 5);
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+        // bitmask of the bytes in the 64 byte block at p that are any of Cs
+        template <char... Cs>
+        inline std::uint64_t block_mask_sse2(const char* p)
+        {
+            std::uint64_t m = 0;
+            for(size_t i = 0; i < 64; i += 16)
+            {
+                auto v = _mm_loadu_si128((const __m128i*)(p + i));
+                auto eq = _mm_setzero_si128();
+                ((eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v, _mm_set1_epi8(Cs)))), ...);
+                m |= std::uint64_t(unsigned(_mm_movemask_epi8(eq))) << i;
+            }
+            return m;
+        }
+
+        template <char... Cs>
+        CMD_TARGET_AVX2 inline std::uint64_t block_mask_avx2(const char* p)
+        {
+            std::uint64_t m = 0;
+            for(size_t i = 0; i < 64; i += 32)
+            {
+                auto v = _mm256_loadu_si256((const __m256i*)(p + i));
+                auto eq = _mm256_setzero_si256();
+                ((eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(Cs)))), ...);
+                m |= std::uint64_t(unsigned(_mm256_movemask_epi8(eq))) << i;
+            }
+            return m;
+        }
+
+        // finds the first byte classified by Mask, 64 bytes at a time.
+        // The tail is padded with zeros, which must not be classified.
+        // It is always inlined, so that it is compiled for the target of its caller.
+        template <std::uint64_t (*Mask)(const char*)>
+        CMD_ALWAYS_INLINE size_t find_blocks(std::string_view s)
+        {
+            size_t i = 0;
+            for(; i + 64 <= s.size(); i += 64)
+                if(auto m = Mask(s.data() + i))
+                    return i + std::countr_zero(m);
+            if(i < s.size())
+            {
+                char tail[64] = {};
+                std::memcpy(tail, s.data() + i, s.size() - i);
+                if(auto m = Mask(tail))
+                    return i + std::countr_zero(m);
+            }
+            return s.npos;
+        }
+
+        template <char... Cs>
+        size_t find_blocks_sse2(std::string_view s)
+        {
+            return find_blocks<block_mask_sse2<Cs...>>(s);
+        }
+
+        // the whole loop is compiled for AVX2, which inlines block_mask_avx2 into it
+        template <char... Cs>
+        CMD_TARGET_AVX2 size_t find_blocks_avx2(std::string_view s)
+        {
+            return find_blocks<block_mask_avx2<Cs...>>(s);
+        }
+#endif
+
+        // finds the first of Cs in s.
+        // A single character is left to memchr, which is already vectorized. Several characters
+        // are classified with AVX2 or SSE2 on x86-64, selected once at runtime, and left to the
+        // standard library elsewhere.
+        template <char... Cs>
+        inline size_t find_any(std::string_view s)
+        {
+            static_assert(((Cs != 0) && ...));
+            if constexpr(sizeof...(Cs) == 1)
+                return s.find(Cs...);
+            else
+            {
+#ifdef CMD_SIMD_X86
+                static const auto impl = cpu_has_avx2() ? &find_blocks_avx2<Cs...>
+                                                        : &find_blocks_sse2<Cs...>;
+                return impl(s);
+#else
+                constexpr char cs[] = {Cs..., 0};
+                return s.find_first_of(cs);
+#endif
+            }
+        }
+    } // namespace detail::simd
+
+    // token_cursor tokenizes line lazily with the semantics of tokenize, scanning no further than
+    // the tokens pulled so far. As with tokenize(line, storage), tokens are views into line except
+    // for those spliced from several segments, which are materialized in storage.
+    // storage is overwritten, the tokens are valid as long as line and storage are.
+    // It is an input range of std::string_view.
+    class token_cursor
+    {
+      public:
+        class iterator;
+        struct sentinel
+        {
+        };
+
+        token_cursor(std::string_view line, std::string& storage) noexcept
+            : base{line.data()}, rest{line}, storage{&storage}, last{line.data()}
+        {
+        }
+
+        // a copy would splice into the same storage
+        token_cursor(const token_cursor&) = delete;
+        token_cursor& operator=(const token_cursor&) = delete;
+
+        // scans the next token, returns std::nullopt past the last one.
+        // An unclosed quote ends the line, the token it is in is still returned.
+        std::optional<std::string_view> next()
+        {
+            while(true)
+            {
+                skip_spaces();
+                if(rest.empty())
+                    return std::nullopt;
+                if(auto tok = scan(); tok.size() > 0 || unclosed)
+                    return tok;
+                // an empty pair of quotes isn't a token
+            }
+        }
+
+        // whether no tokens remain, scans no further than the beginning of the next token,
+        // whose offset is then that of the last token
+        bool at_end()
+        {
+            while(true)
+            {
+                skip_spaces();
+                if(rest.empty())
+                    return true;
+                // only empty pairs of quotes up to a space make no token
+                size_t i = 0;
+                while(i + 1 < rest.size() && (rest[i] == '"' || rest[i] == '\'') &&
+                      rest[i + 1] == rest[i])
+                    i += 2;
+                if(i < rest.size() && rest[i] != ' ')
+                {
+                    last = rest.data() + i;
+                    return false;
+                }
+                rest.remove_prefix(i);
+            }
+        }
+
+        // converts the next token where it lies by parse(first, last), which parses a prefix of
+        // the rest of the line and advances first past it, such as from_string<T> for numbers.
+        // The token is then scanned once, by parse. It only succeeds if the prefix is the whole
+        // token, unquoted or within a single pair of quotes, otherwise nothing is consumed, the
+        // result is empty and the token is left to next().
+        template <typename F>
+        auto parse_next(F&& parse) -> decltype(parse(std::declval<const char*&>(), nullptr))
+        {
+            skip_spaces();
+            auto first = rest.data(), end = first + rest.size();
+            auto p = first;
+            char q = 0;
+            if(p != end && (*p == '"' || *p == '\''))
+                q = *p++;
+            if(p == end)
+                return {};
+
+            auto start = p;
+            auto x = parse(p, end);
+            if(!x || p == start)
+                return {};
+            if(q && (p == end || *p++ != q))
+                return {};
+            if(p != end && *p != ' ')
+                return {};
+            last = first;
+            rest.remove_prefix(size_t(p - first));
+            return x;
+        }
+
+        // the unclosed quote, if any, once the line is scanned to its end
+        char quote() const noexcept { return unclosed; }
+
+        // the offset in line of the last token scanned, that of its first non-empty segment, the
+        // opening quote included if it is quoted
+        size_t offset() const noexcept { return size_t(last - base); }
+
+        iterator begin();
+        sentinel end() const noexcept { return {}; }
+
+      private:
+        void skip_spaces() noexcept
+        {
+            size_t i = 0;
+            while(i < rest.size() && rest[i] == ' ')
+                i++;
+            rest.remove_prefix(i);
+        }
+
+        // finds the first space or quote in s. Tokens are mostly short, the first bytes are
+        // checked one at a time before paying the fixed cost of find_any.
+        static size_t find_delimiter(std::string_view s)
+        {
+            constexpr size_t n = 16;
+            for(size_t i = 0; i < s.size() && i < n; i++)
+                if(s[i] == ' ' || s[i] == '"' || s[i] == '\'')
+                    return i;
+            if(s.size() <= n)
+                return s.npos;
+            auto i = detail::simd::find_any<' ', '"', '\''>(s.substr(n));
+            return i == s.npos ? i : i + n;
+        }
+
+        // scans a token starting at rest, which doesn't start with a space
+        std::string_view scan()
+        {
+            std::string_view cur;
+            const char* start = nullptr; // the first non-empty segment, or the quote opening it
+            bool owned = false;          // whether cur lives in storage
+
+            auto append = [&](std::string_view seg, bool quoted) {
+                if(seg.empty())
+                    return;
+                if(cur.empty())
+                {
+                    cur = seg;
+                    start = quoted ? seg.data() - 1 : seg.data();
+                }
+                else
+                {
+                    cur = splice(cur, seg, owned);
+                    owned = true;
+                }
+            };
+
+            while(true)
+            {
+                auto i = find_delimiter(rest);
+                if(i == rest.npos)
+                {
+                    append(rest, false);
+                    rest.remove_prefix(rest.size());
+                    break;
+                }
+                append(rest.substr(0, i), false);
+                auto q = rest[i];
+                rest.remove_prefix(i + 1);
+                if(q == ' ')
+                    break;
+
+                auto j = q == '"' ? detail::simd::find_any<'"'>(rest)
+                                  : detail::simd::find_any<'\''>(rest);
+                if(j == rest.npos)
+                {
+                    append(rest, true);
+                    rest.remove_prefix(rest.size());
+                    unclosed = q;
+                    break;
+                }
+                append(rest.substr(0, j), true);
+                rest.remove_prefix(j + 1);
+            }
+
+            // only an empty token with an unclosed quote has no segment, its quote is the last
+            // character
+            last = start ? start : rest.data() - 1;
+            return cur;
+        }
+
+        // appends seg to cur, moving cur to storage unless it is already there
+        std::string_view splice(std::string_view cur, std::string_view seg, bool owned)
+        {
+            if(!owned)
+            {
+                // spliced tokens never outgrow the line, storage is never reallocated after this
+                // and previously returned views stay valid
+                if(!prepared)
+                {
+                    storage->clear();
+                    storage->reserve(size_t(rest.data() + rest.size() - base));
+                    prepared = true;
+                }
+                auto off = storage->size();
+                *storage += cur;
+                cur = {storage->data() + off, cur.size()};
+            }
+            *storage += seg;
+            return {cur.data(), cur.size() + seg.size()};
+        }
+
+        const char* base;
+        std::string_view rest;
+        std::string* storage;
+        // the first non-empty segment of the last token, or the quote opening it
+        const char* last = nullptr;
+        char unclosed = 0;
+        bool prepared = false; // whether storage is ready to splice into
+    };
+
+    class token_cursor::iterator
+    {
+      public:
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(token_cursor& c) : c{&c}, cur{c.next()} {}
+
+        std::string_view operator*() const { return *cur; }
+
+        iterator& operator++()
+        {
+            cur = c->next();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, sentinel) { return !it.cur; }
+
+      private:
+        token_cursor* c = nullptr;
+        std::optional<std::string_view> cur;
+    };
+
+    inline token_cursor::iterator token_cursor::begin() { return iterator{*this}; }
+
+    namespace detail
+    {
+        // the arguments of a prepared command, see prepared_command
+        class prepared_args
+        {
+          public:
+            virtual ~prepared_args() = default;
+
+            // converts tok to argument i, returns whether it succeeded
+            virtual bool bind(size_t i, std::string_view tok) = 0;
+
+            // appends the result to out, fails if an argument isn't converted
+            virtual bool invoke(std::string& out) = 0;
+
+            std::string line, storage; // the constants may view into these
+            std::vector<size_t> holes; // argument indices of the placeholders
+        };
+
+        template <typename R, typename... Args, typename F>
+        std::unique_ptr<prepared_args> prepare_args(const F& f, std::string_view line);
+
+        class overload_set;
+
+        // a compact id for each type, the address of a variable unique to it
+        template <typename T>
+        inline char type_tag = 0;
+
+        template <typename T>
+        constexpr const void* type_id()
+        {
+            return &type_tag<T>;
+        }
+
+        // what an argument of type T accepts for telling whether an overload shadows another:
+        // strings accept any token, the numbers cmd parses itself the tokens in their range,
+        // other types only what they accept themselves
+        struct param_info
+        {
+            enum kinds
+            {
+                other,
+                string,
+                integral,
+                floating,
+            };
+
+            const void* type;
+            kinds kind = other;
+            bool is_signed = false;
+            int digits = 0; // of std::numeric_limits, or max_exponent for floating types
+
+            // whether every token accepted as this is also accepted as p
+            constexpr bool within(const param_info& p) const
+            {
+                if(type == p.type || p.kind == string)
+                    return true;
+                if(kind == integral && p.kind == floating)
+                    return digits <= 64; // which are all in range of a float
+                if(kind != p.kind || (kind != integral && kind != floating))
+                    return false;
+                if(kind == floating)
+                    return digits <= p.digits;
+                return (!is_signed || p.is_signed) && digits <= p.digits;
+            }
+        };
+
+        template <typename T>
+        constexpr param_info param_info_of()
+        {
+            using L = std::numeric_limits<T>;
+            if constexpr(std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+                return {type_id<T>(), param_info::string};
+            else if constexpr(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+                return {type_id<T>(), param_info::integral, L::is_signed, L::digits};
+            else if constexpr(std::is_floating_point_v<T>)
+                return {type_id<T>(), param_info::floating, true, L::max_exponent};
+            else
+                return {type_id<T>()};
+        }
+
+        // the result of calling with typed arguments, bool for void
+        template <typename R>
+        using optional_result =
+            std::conditional_t<std::is_void_v<R>, bool, std::optional<std::decay_t<R>>>;
+    } // namespace detail
+
+    // errc is why a call failed, errc{} if it didn't
+    enum class errc : std::uint8_t
+    {
+        empty_line = 1,
+        unclosed_quote,
+        unknown_command,
+        wrong_arity,
+        bad_argument, // from_string failed
+    };
+
+    // call_error describes why a call failed.
+    // arg is the index of the argument, the name excluded, that failed to convert, of the
+    // first argument that is missing or extra, or that an unclosed quote is in. offset is the
+    // byte offset into the line of the failing token, the command name for an unknown command,
+    // the unclosed token for an unclosed quote and the end of the line for a missing argument.
+    // The offset of a token is that of its first non-empty segment, e.g. of x in ""x.
+    // The line is scanned up to the first failure. An extra argument is an unclosed_quote if it
+    // opens a quote that is never closed, wrong_arity otherwise. Overloads first scan the line
+    // to count its tokens, up to one more than any of them takes, so an unclosed quote there
+    // comes first, and a number of tokens no overload takes is reported as for the overload
+    // taking the most arguments below it, or failing that the fewest.
+    struct call_error
+    {
+        errc code{};
+        size_t arg = 0;
+        size_t offset = 0;
+    };
+
+    // result holds either a value or a call_error, akin to std::expected. Neither holding
+    // an error nor checking it allocates or throws.
+    template <typename T>
+    class result
+    {
+      public:
+        result(T value) : val{std::move(value)} {}
+        result(call_error err) : err{err} {}
+
+        explicit operator bool() const { return err.code == errc{}; }
+        bool has_value() const { return bool(*this); }
+
+        // the value, only valid if there is one
+        const T& value() const { return val; }
+        const T& operator*() const { return val; }
+        const T* operator->() const { return &val; }
+
+        // the error, with code errc{} if there is none
+        const call_error& error() const { return err; }
+
+      private:
+        T val{};
+        call_error err;
+    };
+
+    template <>
+    class result<void>
+    {
+      public:
+        result() = default;
+        result(call_error err) : err{err} {}
+
+        explicit operator bool() const { return err.code == errc{}; }
+        bool has_value() const { return bool(*this); }
+
+        const call_error& error() const { return err; }
+
+      private:
+        call_error err;
+    };
+
+    namespace detail
+    {
+        // the outcome of converting tokens and calling, small enough to be returned in a
+        // register. arg is as in call_error.
+        struct status
+        {
+            errc code{};
+            std::uint32_t arg = 0;
+
+            explicit operator bool() const { return code == errc{}; }
+        };
+
+        // converts toks to the arguments of fn by from_string, calls it and appends the result
+        // to out, a sink. returns whether it succeeded, out is unchanged on failure.
+        template <typename Toks, typename F, typename Out>
+        inline status dispatch(F& fn, Toks toks, Out& out)
+        {
+            return [&]<typename R, typename... Args>(R(*)(Args...)) {
+                if(toks.size() != sizeof...(Args))
+                    return status{errc::wrong_arity,
+                                  std::uint32_t((std::min)(toks.size(), sizeof...(Args)))};
+
+                return index_upto<sizeof...(Args)>([&](auto... is) {
+                    auto optargs = std::tuple{
+                        from_string<std::remove_cvref_t<Args>>{}(std::move(toks[is]))...};
+                    [[maybe_unused]] std::uint32_t bad = 0;
+                    if(!((get<is>(optargs) || (bad = is, false)) && ...))
+                        return status{errc::bad_argument, bad};
+                    using rR = std::remove_cvref_t<R>;
+                    if constexpr(!std::is_void_v<rR>)
+                        append_to(fn(std::forward<Args>(*get<is>(optargs))...), out);
+                    else
+                        fn(std::forward<Args>(*get<is>(optargs))...);
+                    return status{};
+                });
+            }((signature_t<F>*)nullptr);
+        }
+
+        // Same as above, but the tokens are pulled from toks one at a time and each is converted
+        // as soon as it is scanned. It fails at the first token that is missing, extra, unclosed
+        // or doesn't convert, the rest of the line is never scanned.
+        // Arguments whose from_string parses in place, such as numbers, are converted straight
+        // from the line in the same pass, see token_cursor::parse_next.
+        template <typename F, typename Out>
+        inline status dispatch(F& fn, token_cursor& toks, Out& out)
+        {
+            return [&]<typename R, typename... Args>(R(*)(Args...)) {
+                return index_upto<sizeof...(Args)>([&](auto... is) {
+                    std::tuple<std::optional<std::remove_cvref_t<Args>>...> optargs;
+                    status st;
+                    [[maybe_unused]] auto pull = [&](auto i) {
+                        using T = std::remove_cvref_t<std::tuple_element_t<i, std::tuple<Args...>>>;
+                        if constexpr(requires(const char* p) { from_string<T>{}(p, p); })
+                        {
+                            if(auto arg = toks.parse_next(from_string<T>{}))
+                            {
+                                get<i>(optargs).emplace(std::move(*arg));
+                                return true;
+                            }
+                        }
+                        auto tok = toks.next();
+                        if(!tok)
+                            st = {errc::wrong_arity, std::uint32_t(i)};
+                        else if(toks.quote())
+                            st = {errc::unclosed_quote, std::uint32_t(i)};
+                        else if(auto arg = from_string<T>{}(*tok))
+                            get<i>(optargs).emplace(std::move(*arg));
+                        else
+                            st = {errc::bad_argument, std::uint32_t(i)};
+                        return bool(st);
+                    };
+                    if(!(pull(is) && ...))
+                        return st;
+                    if(!toks.at_end())
+                        return status{errc::wrong_arity, std::uint32_t(sizeof...(Args))};
+
+                    using rR = std::remove_cvref_t<R>;
+                    if constexpr(!std::is_void_v<rR>)
+                        append_to(fn(std::forward<Args>(*get<is>(optargs))...), out);
+                    else
+                        fn(std::forward<Args>(*get<is>(optargs))...);
+                    return status{};
+                });
+            }((signature_t<F>*)nullptr);
+        }
+    } // namespace detail
+
+    // erased_func is a type-erased function which can be called with a span of strings or
+    // string_views or a token_list, where each token is converted to their respective argument
+    // by from_string.
+    // erased_func can be constructed from any stringable_callable: a function pointer, a lambda,
+    // with or without captures, or a function object with a single non-template operator().
+    // Callables of up to CMD_FUNC_BUFFER_SIZE bytes are stored inline, larger ones on the heap.
+    // Calling goes through a single indirect call to code specific to the callable.
+    class erased_func
+    {
+        static constexpr size_t buffer_size = CMD_FUNC_BUFFER_SIZE;
+        static_assert(buffer_size >= sizeof(void*));
+
+        template <typename F>
+        static constexpr bool stored_inline = sizeof(F) <= buffer_size &&
+                                              alignof(F) <= alignof(void*) &&
+                                              std::is_nothrow_move_constructible_v<F>;
+
+        // the callable in buf, which is only ever called as const, see stringable_callable
+        template <typename F>
+        static const F& get(const void* buf)
+        {
+            if constexpr(stored_inline<F>)
+                return *std::launder((const F*)buf);
+            else
+                return **(F* const*)buf;
+        }
+
+        enum class op
+        {
+            copy,
+            move,
+            destroy
+        };
+
+        // copies or moves the callable in src to dst, or destroys the callable in dst
+        template <typename F>
+        static void manage(op o, void* dst, void* src)
+        {
+            if constexpr(stored_inline<F>)
+            {
+                if(o == op::copy)
+                    new(dst) F(get<F>(src));
+                else if(o == op::move)
+                    new(dst) F(std::move(get<F>(src)));
+                else
+                    get<F>(dst).~F();
+            }
+            else
+            {
+                if(o == op::copy)
+                    *(F**)dst = new F(get<F>(src));
+                else if(o == op::move)
+                    *(F**)dst = std::exchange(*(F**)src, nullptr);
+                else
+                    delete *(F**)dst;
+            }
+        }
+
+        // Out is std::string& or detail::sink_ref
+        template <typename Toks, typename F, typename Out>
+        static detail::status dispatch_func(const void* buf, Toks toks, Out out)
+        {
+            return detail::dispatch(get<F>(buf), toks, out);
+        }
+
+        template <typename F, typename R, typename... Args>
+        static std::unique_ptr<detail::prepared_args> prepare_func(const void* buf,
+                                                                   std::string_view line)
+        {
+            return detail::prepare_args<R, Args...>(get<F>(buf), line);
+        }
+
+        // called by invoke with pointers to the decayed arguments, which are then owned by the
+        // callee, and to an std::optional for the result unless it is void
+        template <typename F, typename R, typename... Args>
+        static void typed_func(const void* buf, void* result, void* const* args)
+        {
+            auto& fn = get<F>(buf);
+            detail::index_upto<sizeof...(Args)>([&](auto... is) {
+                if constexpr(std::is_void_v<R>)
+                    fn(static_cast<Args&&>(*(std::decay_t<Args>*)args[is])...);
+                else
+                    ((std::optional<std::decay_t<R>>*)result)
+                        ->emplace(fn(static_cast<Args&&>(*(std::decay_t<Args>*)args[is])...));
+            });
+        }
+
+        // the operations of a callable type, shared by every erased_func storing that type
+        struct ops
+        {
+            using status = detail::status;
+            status (*dispatch)(const void*, std::span<std::string>, std::string&);
+            status (*dispatch_view)(const void*, std::span<const std::string_view>, std::string&);
+            status (*dispatch_list)(const void*, token_list_view, std::string&);
+            status (*dispatch_view_sink)(const void*, std::span<const std::string_view>,
+                                         detail::sink_ref);
+            status (*dispatch_list_sink)(const void*, token_list_view, detail::sink_ref);
+            status (*dispatch_cursor)(const void*, token_cursor&, std::string&);
+            status (*dispatch_cursor_sink)(const void*, token_cursor&, detail::sink_ref);
+            std::unique_ptr<detail::prepared_args> (*prepare_args)(const void*, std::string_view);
+            void (*typed)(const void*, void*, void* const*);
+            void (*manage)(op, void*, void*); // null if the callable is trivial and inline
+            const void* signature;
+            size_t arity;
+            const detail::param_info* params; // of the decayed arguments
+        };
+
+        template <typename... Args>
+        static constexpr detail::param_info params_for[] = {
+            detail::param_info_of<std::decay_t<Args>>()..., detail::param_info{nullptr}};
+
+        template <typename F, typename R, typename... Args>
+        static constexpr ops ops_for = {
+            dispatch_func<std::span<std::string>, F, std::string&>,
+            dispatch_func<std::span<const std::string_view>, F, std::string&>,
+            dispatch_func<token_list_view, F, std::string&>,
+            dispatch_func<std::span<const std::string_view>, F, detail::sink_ref>,
+            dispatch_func<token_list_view, F, detail::sink_ref>,
+            dispatch_func<token_cursor&, F, std::string&>,
+            dispatch_func<token_cursor&, F, detail::sink_ref>,
+            prepare_func<F, R, Args...>,
+            typed_func<F, R, Args...>,
+            stored_inline<F> && std::is_trivially_copyable_v<F> ? nullptr : manage<F>,
+            detail::type_id<std::decay_t<R>(std::decay_t<Args>...)>(),
+            sizeof...(Args),
+            params_for<Args...>,
+        };
+
+        template <typename F, typename R, typename... Args>
+        static const ops* ops_of(R (*)(Args...))
+        {
+            return &ops_for<F, R, Args...>;
+        }
+
+      public:
+        erased_func() = default;
+
+        template <typename F>
+        requires stringable_callable<F> erased_func(F&& f)
+            : fops{ops_of<std::decay_t<F>>((detail::signature_t<F>*)nullptr)}
+        {
+            using D = std::decay_t<F>;
+            if constexpr(stored_inline<D>)
+                new(buf) D(std::forward<F>(f));
+            else
+                *(D**)buf = new D(std::forward<F>(f));
+        }
+
+        erased_func(const erased_func& other) : fops{other.fops}
+        {
+            if(fops && fops->manage)
+                fops->manage(op::copy, buf, (void*)other.buf);
+            else
+                std::memcpy(buf, other.buf, buffer_size);
+        }
+
+        erased_func(erased_func&& other) noexcept : fops{other.fops}
+        {
+            if(fops && fops->manage)
+                fops->manage(op::move, buf, other.buf);
+            else
+                std::memcpy(buf, other.buf, buffer_size);
+        }
+
+        erased_func& operator=(erased_func other) noexcept
+        {
+            this->~erased_func();
+            return *new(this) erased_func{std::move(other)};
+        }
+
+        ~erased_func()
+        {
+            if(fops && fops->manage)
+                fops->manage(op::destroy, buf, nullptr);
+        }
+
+        std::optional<std::string> call(std::span<std::string> toks) const
+        {
+            std::string out;
+            if(!fops->dispatch(buf, toks, out))
+                return {};
+            return out;
+        }
+
+        // The tokens are passed to from_string as is, no std::string is constructed unless
+        // the argument itself is a std::string.
+        std::optional<std::string> call(std::span<const std::string_view> toks) const
+        {
+            std::string out;
+            if(!call(toks, out))
+                return {};
+            return out;
+        }
+
+        std::optional<std::string> call(token_list_view toks) const
+        {
+            std::string out;
+            if(!call(toks, out))
+                return {};
+            return out;
+        }
+
+        // appends the result to out and returns true on success, out is unchanged on failure.
+        // out is a std::string or any other sink, appended to through one more indirect call
+        // per append.
+        template <sink S>
+        bool call(std::span<const std::string_view> toks, S& out) const
+        {
+            return bool(dispatch(toks, out));
+        }
+
+        template <sink S>
+        bool call(token_list_view toks, S& out) const
+        {
+            return bool(dispatch(toks, out));
+        }
+
+        // calls the function with typed arguments, without converting from and to strings.
+        // The signature must be R(Args...) up to references and cv-qualifiers, otherwise the
+        // function isn't called and the result is empty. The arguments are passed by value.
+        template <typename R, typename... Args>
+        detail::optional_result<R> invoke(Args&&... args) const
+        {
+            if(!has_signature<R, Args...>())
+                return {};
+
+            return [&](std::decay_t<Args>... xs) -> detail::optional_result<R> {
+                void* ptrs[] = {(void*)&xs..., nullptr};
+                if constexpr(std::is_void_v<R>)
+                {
+                    fops->typed(buf, nullptr, ptrs);
+                    return true;
+                }
+                else
+                {
+                    detail::optional_result<R> res;
+                    fops->typed(buf, &res, ptrs);
+                    return res;
+                }
+            }(std::forward<Args>(args)...);
+        }
+
+        // tokenizes line, the command line including the name, and converts the arguments that
+        // aren't placeholders, returns null on failure. See prepared_command.
+        // The prepared command holds its own copy of the callable.
+        std::unique_ptr<detail::prepared_args> prepare(std::string_view line) const
+        {
+            return fops->prepare_args(buf, line);
+        }
+
+        // whether the signature is R(Args...) up to references and cv-qualifiers
+        template <typename R, typename... Args>
+        bool has_signature() const
+        {
+            return fops->signature == detail::type_id<std::decay_t<R>(std::decay_t<Args>...)>();
+        }
+
+        size_t arity() const { return fops->arity; }
+
+        // whether every tokens accepted by other are also accepted by this, as far as can be
+        // told from the signatures: the same arity, and each argument of this either of the
+        // same type as in other, a string, which accepts any token, or a number whose range
+        // includes that of the number in other, such as a double for an int or a long long
+        // for an unsigned int.
+        bool shadows(const erased_func& other) const
+        {
+            if(arity() != other.arity())
+                return false;
+            for(size_t i = 0; i < arity(); i++)
+                if(!other.fops->params[i].within(fops->params[i]))
+                    return false;
+            return true;
+        }
+
+      private:
+        friend class detail::overload_set;
+
+        template <sink S>
+        detail::status dispatch(std::span<const std::string_view> toks, S& out) const
+        {
+            if constexpr(std::is_same_v<S, std::string>)
+                return fops->dispatch_view(buf, toks, out);
+            else
+                return fops->dispatch_view_sink(buf, toks, detail::sink_ref{out});
+        }
+
+        template <sink S>
+        detail::status dispatch(token_list_view toks, S& out) const
+        {
+            if constexpr(std::is_same_v<S, std::string>)
+                return fops->dispatch_list(buf, toks, out);
+            else
+                return fops->dispatch_list_sink(buf, toks, detail::sink_ref{out});
+        }
+
+        template <sink S>
+        detail::status dispatch(token_cursor& toks, S& out) const
+        {
+            if constexpr(std::is_same_v<S, std::string>)
+                return fops->dispatch_cursor(buf, toks, out);
+            else
+                return fops->dispatch_cursor_sink(buf, toks, detail::sink_ref{out});
+        }
+
+        const ops* fops = nullptr;
+        alignas(void*) unsigned char buf[buffer_size] = {};
+    };
+
+    // bind_member binds a member function pointer to an object, making a callable that can
+    // be registered, e.g.
+    //      r.register_func("foo", bind_member(&widget::foo, &w));
+    // calls w.foo. The object isn't copied and must outlive the callable.
+    template <typename C, typename M>
+    requires std::is_member_function_pointer_v<M> auto bind_member(M fn, C* obj)
+    {
+        return [&]<typename R, typename... Args>(R(*)(Args...)) {
+            return [fn, obj](Args... args) -> R {
+                return std::invoke(fn, obj, std::forward<Args>(args)...);
+            };
+        }((detail::signature_t<M>*)nullptr);
+    }
+
+    namespace detail
+    {
+        // overload_set holds the functions registered under one name. A call is dispatched by
+        // the number of tokens first, through an array indexed by arity, then to the first
+        // overload of that arity, in registration order, whose arguments all convert.
+        // A single function is stored inline and called directly without indexing, the index
+        // takes its place once there are overloads, so the set is no larger than erased_func.
+        class overload_set
+        {
+            struct arity_index
+            {
+                erased_func first;
+                std::vector<std::vector<erased_func>> funcs; // funcs[n] take n arguments
+            };
+
+            // overlays erased_func, whose fops is never null, fops is null for an index
+            struct indexed
+            {
+                const erased_func::ops* fops = nullptr;
+                arity_index* index = nullptr;
+            };
+
+          public:
+            overload_set() : many{} {}
+            overload_set(const erased_func& func) : one{func} {}
+
+            overload_set(const overload_set& other) : many{}
+            {
+                if(other.single())
+                    new(&one) erased_func{other.one};
+                else if(other.many.index)
+                    many.index = new arity_index{*other.many.index};
+            }
+
+            overload_set(overload_set&& other) noexcept : many{}
+            {
+                if(other.single())
+                    new(&one) erased_func{std::move(other.one)};
+                else
+                    std::swap(many.index, other.many.index);
+            }
+
+            overload_set& operator=(overload_set other) noexcept
+            {
+                this->~overload_set();
+                return *new(this) overload_set{std::move(other)};
+            }
+
+            ~overload_set()
+            {
+                if(single())
+                    one.~erased_func();
+                else
+                    delete many.index;
+            }
+
+            // the first function registered, null if there is none
+            const erased_func* front() const
+            {
+                if(single())
+                    return &one;
+                return many.index ? &many.index->first : nullptr;
+            }
+
+            // adds func unless an overload registered before shadows it, in which case it would
+            // never be called. returns whether it was added.
+            bool add(const erased_func& func)
+            {
+                if(single())
+                {
+                    if(one.shadows(func))
+                        return false;
+                    auto index = new arity_index{one, {}};
+                    push(*index, one);
+                    one.~erased_func();
+                    new(&many) indexed{nullptr, index};
+                }
+                else if(!many.index)
+                {
+                    *this = func;
+                    return true;
+                }
+                else if(func.arity() < many.index->funcs.size())
+                {
+                    for(auto& f : many.index->funcs[func.arity()])
+                        if(f.shadows(func))
+                            return false;
+                }
+                push(*many.index, func);
+                return true;
+            }
+
+            // appends the result to out, out is unchanged on failure. If every overload fails,
+            // the status is of the one that converted the most arguments. If none takes as many
+            // arguments as there are tokens, the status is as for a single function taking the
+            // most arguments below that, the first extra argument, otherwise the first missing.
+            template <typename Toks, typename Out>
+            status call(Toks toks, Out& out) const
+            {
+                if(single())
+                    return one.dispatch(toks, out);
+                auto cs = candidates(toks.size());
+                if(cs.empty())
+                    return {errc::wrong_arity, std::uint32_t(nearest_arity(toks.size()))};
+                status best;
+                for(auto& f : cs)
+                {
+                    auto st = f.dispatch(toks, out);
+                    if(st)
+                        return st;
+                    if(best.code == errc{} || st.arg > best.arg)
+                        best = st;
+                }
+                return best;
+            }
+
+            // Same as above, with the arguments pulled lazily from toks, see dispatch. Overloads
+            // are dispatched by the number of tokens, so the rest of the line is first scanned
+            // into all, after name, up to one more token than any overload takes. all is left
+            // as is for a single function.
+            template <typename Out>
+            status call(token_cursor& toks, std::string_view name,
+                        std::vector<std::string_view>& all, Out& out) const
+            {
+                if(single())
+                    return one.dispatch(toks, out);
+                all.assign(1, name);
+                auto most = many.index ? many.index->funcs.size() : 0;
+                while(all.size() <= most)
+                {
+                    auto tok = toks.next();
+                    if(!tok)
+                        break;
+                    all.push_back(*tok);
+                }
+                if(toks.quote())
+                    return {errc::unclosed_quote, std::uint32_t(all.size() - 2)};
+                return call(std::span<const std::string_view>{all}.subspan(1), out);
+            }
+
+            template <typename Toks>
+            std::optional<std::string> call(Toks toks) const
+            {
+                std::string out;
+                if(!call(toks, out))
+                    return {};
+                return out;
+            }
+
+            // the tokens are only moved from by the last candidate, the ones before may fail
+            // after converting some of them and are called with views of the tokens instead
+            std::optional<std::string> call(std::span<std::string> toks) const
+            {
+                if(single())
+                    return one.call(toks);
+                auto cs = candidates(toks.size());
+                if(cs.empty())
+                    return {};
+                if(cs.size() > 1)
+                {
+                    std::vector<std::string_view> views(toks.begin(), toks.end());
+                    for(auto& f : cs.first(cs.size() - 1))
+                        if(auto res = f.call(std::span<const std::string_view>{views}))
+                            return res;
+                }
+                return cs.back().call(toks);
+            }
+
+            // calls the overload of signature R(Args...), see erased_func::invoke
+            template <typename R, typename... Args>
+            optional_result<R> invoke(Args&&... args) const
+            {
+                if(single())
+                    return one.template invoke<R>(std::forward<Args>(args)...);
+                for(auto& f : candidates(sizeof...(Args)))
+                    if(f.template has_signature<R, Args...>())
+                        return f.template invoke<R>(std::forward<Args>(args)...);
+                return {};
+            }
+
+            // prepares the first overload taking arity arguments whose constants convert
+            std::unique_ptr<prepared_args> prepare(std::string_view line, size_t arity) const
+            {
+                if(single())
+                    return one.prepare(line);
+                for(auto& f : candidates(arity))
+                    if(auto args = f.prepare(line))
+                        return args;
+                return {};
+            }
+
+          private:
+            bool single() const { return many.fops; }
+
+            static void push(arity_index& index, const erased_func& func)
+            {
+                if(func.arity() >= index.funcs.size())
+                    index.funcs.resize(func.arity() + 1);
+                index.funcs[func.arity()].push_back(func);
+            }
+
+            // the index of the first extra or missing argument when no overload takes arity
+            // arguments, see call
+            size_t nearest_arity(size_t arity) const
+            {
+                if(!many.index)
+                    return 0;
+                auto& funcs = many.index->funcs;
+                for(size_t n = (std::min)(arity, funcs.size()); n-- > 0;)
+                    if(!funcs[n].empty())
+                        return n;
+                return arity;
+            }
+
+            // the overloads taking arity arguments
+            std::span<const erased_func> candidates(size_t arity) const
+            {
+                if(!many.index || arity >= many.index->funcs.size())
+                    return {};
+                return many.index->funcs[arity];
+            }
+
+            union
+            {
+                erased_func one;
+                indexed many;
+            };
+        };
+    } // namespace detail
+
+    namespace detail
+    {
+        // scans line with a token_cursor and calls emit(std::string_view) on each token.
+        // If emit also takes a size_t, it is passed the offset of the token, see
+        // token_cursor::offset. returns whether there is an unclosed quote.
+        template <typename F>
+        inline char scan_tokens(std::string_view line, std::string& storage, F&& emit)
+        {
+            token_cursor c{line, storage};
+            while(auto tok = c.next())
+            {
+                if constexpr(std::is_invocable_v<F&, std::string_view, size_t>)
+                    emit(*tok, c.offset());
+                else
+                    emit(*tok);
+            }
+            return c.quote();
+        }
+    } // namespace detail
+
+    namespace detail
+    {
+        // calls f(std::string_view) on each line of lines, a trailing newline doesn't start
+        // another line
+        template <typename F>
+        inline void for_each_line(std::string_view lines, F&& f)
+        {
+            while(lines.size() > 0)
+            {
+                auto i = lines.find('\n');
+                f(lines.substr(0, i));
+                if(i == lines.npos)
+                    break;
+                lines = lines.substr(i + 1);
+            }
+        }
+    } // namespace detail
+
+    // tokenize has bash semantics, e.g.
+    //      a b'c d'e f'"g"'
+    // will be tokenized as
+    //      a
+    //      bc de
+    //      f"g"
+    // returns the tokens and whether there is an unclosed quote.
+    inline std::pair<std::vector<std::string>, char> tokenize(std::string_view line)
+    {
+        std::vector<std::string> toks;
+        std::string storage;
+        auto quote = detail::scan_tokens(line, storage, [&](std::string_view tok) {
+            toks.emplace_back(tok);
+        });
+        return std::pair{std::move(toks), quote};
+    }
+
+    // tokenize without copying, the tokens are views into line except for those spliced from
+    // several segments, such as b'c d'e, which are materialized in storage.
+    // storage is overwritten, the tokens are valid as long as line and storage are.
+    inline std::pair<std::vector<std::string_view>, char> tokenize(std::string_view line,
+                                                                   std::string& storage)
+    {
+        std::vector<std::string_view> toks;
+        auto quote = detail::scan_tokens(line, storage,
+                                         [&](std::string_view tok) { toks.push_back(tok); });
+        return std::pair{std::move(toks), quote};
+    }
+
+    // tokenize into a token_list, which is cleared first.
+    // returns whether there is an unclosed quote.
+    inline char tokenize(std::string_view line, token_list& toks)
+    {
+        toks.clear();
+        return detail::scan_tokens(line, toks.scratch,
+                                   [&](std::string_view tok) { toks.push_back(tok); });
+    }
+
+    // stream_tokenizer tokenizes input fed in arbitrary chunks, e.g. read from a socket,
+    // with the semantics of tokenize. Lines are separated by newlines outside of quotes, the
+    // quoting state and the partial token are kept across chunks so each byte is scanned once.
+    // Completed lines are passed to on_line as an std::span<const std::string_view>, which is
+    // only valid during the call. Empty lines are passed as empty spans.
+    class stream_tokenizer
+    {
+      public:
+        template <typename F>
+        void feed(std::string_view chunk, F&& on_line)
+        {
+            while(chunk.size() > 0)
+            {
+                if(sq)
+                {
+                    auto i = detail::simd::find_any<'\''>(chunk);
+                    if(i == chunk.npos)
+                    {
+                        buf += chunk;
+                        return;
+                    }
+                    buf += chunk.substr(0, i);
+                    chunk = chunk.substr(i + 1);
+                    sq = false;
+                }
+                else if(dq)
+                {
+                    auto i = detail::simd::find_any<'"'>(chunk);
+                    if(i == chunk.npos)
+                    {
+                        buf += chunk;
+                        return;
+                    }
+                    buf += chunk.substr(0, i);
+                    chunk = chunk.substr(i + 1);
+                    dq = false;
+                }
+                else
+                {
+                    auto i = detail::simd::find_any<' ', '"', '\'', '\n'>(chunk);
+                    if(i == chunk.npos)
+                    {
+                        buf += chunk;
+                        partial = true;
+                        return;
+                    }
+
+                    buf += chunk.substr(0, i);
+                    partial = true;
+                    switch(chunk[i])
+                    {
+                    case ' ': end_token(); break;
+                    case '\n':
+                        end_token();
+                        end_line(on_line);
+                        break;
+                    case '\'': sq = true; break;
+                    case '"': dq = true; break;
+                    }
+                    chunk = chunk.substr(i + 1);
+                }
+            }
+        }
+
+        // ends the input, passing the last line to on_line if it isn't newline terminated, even
+        // if it has no tokens. returns the unclosed quote, if any, in which case the partial line
+        // is kept.
+        template <typename F>
+        char finish(F&& on_line)
+        {
+            if(quote())
+                return quote();
+            end_token();
+            if(partial)
+                end_line(on_line);
+            return 0;
+        }
+
+        // the quote the input currently ends within, if any
+        char quote() const { return sq ? '\'' : dq ? '"' : 0; }
+
+        // discards the partial line and quoting state
+        void reset()
+        {
+            sq = dq = partial = false;
+            buf.clear();
+            ends.clear();
+        }
+
+      private:
+        void end_token()
+        {
+            auto begin = ends.empty() ? 0 : ends.back();
+            if(buf.size() > begin)
+                ends.push_back(buf.size());
+        }
+
+        template <typename F>
+        void end_line(F& on_line)
+        {
+            views.clear();
+            size_t begin = 0;
+            for(auto end : ends)
+            {
+                views.emplace_back(buf.data() + begin, end - begin);
+                begin = end;
+            }
+            on_line(std::span<const std::string_view>{views});
+            buf.clear();
+            ends.clear();
+            partial = false;
+        }
+
+        bool sq = false, dq = false; // within single and double quotes
+        bool partial = false;        // whether the current line has any bytes
+        std::string buf;             // bytes of the tokens of the current line
+        std::vector<size_t> ends;    // end offsets of the tokens in buf
+        std::vector<std::string_view> views;
+    };
+
+    namespace detail
+    {
+        // whether tok is an unquoted ? in line.
+        // A single character token is never spliced, so it is always a view into line.
+        inline bool is_placeholder(std::string_view line, std::string_view tok)
+        {
+            if(tok != "?")
+                return false;
+            auto i = size_t(tok.data() - line.data());
+            return (i == 0 || line[i - 1] == ' ') && (i + 1 == line.size() || line[i + 1] == ' ');
+        }
+
+        template <typename F, typename R, typename... Args>
+        class typed_prepared_args : public prepared_args
+        {
+          public:
+            explicit typed_prepared_args(const F& fn) : fn{fn} {}
+
+            bool bind(size_t i, std::string_view tok) override
+            {
+                return index_upto<sizeof...(Args)>([&](auto... is) {
+                    bool ok = false;
+                    ((is == i && (ok = bind_at(is, tok))), ...);
+                    return ok;
+                });
+            }
+
+            bool invoke(std::string& out) override
+            {
+                return index_upto<sizeof...(Args)>([&](auto... is) {
+                    if((!get<is>(args) || ...))
+                        return false;
+                    using rR = std::remove_cvref_t<R>;
+                    if constexpr(!std::is_void_v<rR>)
+                        append_to(fn(pass<Args>(*get<is>(args))...), out);
+                    else
+                        fn(pass<Args>(*get<is>(args))...);
+                    return true;
+                });
+            }
+
+            template <size_t I>
+            bool bind_at(std::integral_constant<size_t, I>, std::string_view tok)
+            {
+                auto& arg = get<I>(args);
+                using T = typename std::remove_cvref_t<decltype(arg)>::value_type;
+                arg = from_string<T>{}(tok);
+                return bool(arg);
+            }
+
+            // the stored arguments are reused, so they are copied unless taken by reference
+            template <typename Arg, typename T>
+            static decltype(auto) pass(T& x)
+            {
+                if constexpr(std::is_lvalue_reference_v<Arg>)
+                    return (x);
+                else
+                    return T(x);
+            }
+
+            F fn;
+            std::tuple<std::optional<std::remove_cvref_t<Args>>...> args;
+        };
+
+        template <typename R, typename... Args, typename F>
+        std::unique_ptr<prepared_args> prepare_args(const F& f, std::string_view line)
+        {
+            auto p = std::make_unique<typed_prepared_args<F, R, Args...>>(f);
+            p->line = line;
+            auto [toks, quote] = tokenize(p->line, p->storage);
+            if(quote || toks.size() != sizeof...(Args) + 1)
+                return nullptr;
+
+            bool ok = index_upto<sizeof...(Args)>([&](auto... is) {
+                [[maybe_unused]] auto convert = [&](auto i) {
+                    auto tok = toks[i + 1];
+                    if(!is_placeholder(p->line, tok))
+                        return p->bind_at(i, tok);
+                    p->holes.push_back(i);
+                    return true;
+                };
+                return (convert(is) && ...);
+            });
+            if(!ok)
+                return nullptr;
+            return p;
+        }
+    } // namespace detail
+
+    // prepared_command is a command resolved and parsed once by registry::prepare, where each
+    // unquoted ? is a placeholder bound on every invocation, e.g.
+    //      int foo(int, int);
+    //      auto cmd = r.prepare("foo 42 ?");
+    //      auto opt = cmd.bind("1").invoke();
+    // calls foo(42, 1). Only the bound tokens are converted by invoke, the other arguments are
+    // converted once and passed to every invocation.
+    // prepared_command is move-only and is used by one thread at a time.
+    class prepared_command
+    {
+      public:
+        prepared_command() = default;
+
+        // whether preparing succeeded
+        explicit operator bool() const { return bool(args); }
+
+        // the number of placeholders, 0 if preparing failed
+        size_t placeholders() const { return args ? args->holes.size() : 0; }
+
+        // converts toks to the placeholders in order, there must be a token for each.
+        // On failure, or if preparing failed, invoke fails until the next successful bind.
+        // Arguments viewing into the tokens, e.g. std::string_view, require the tokens to
+        // outlive invoke.
+        template <typename... Toks>
+        prepared_command& bind(const Toks&... toks)
+        {
+            bound = args && sizeof...(Toks) == args->holes.size();
+            if(bound)
+            {
+                size_t i = 0;
+                bound = (args->bind(args->holes[i++], std::string_view{toks}) && ...);
+            }
+            return *this;
+        }
+
+        std::optional<std::string> invoke()
+        {
+            std::string out;
+            if(!invoke(out))
+                return {};
+            return out;
+        }
+
+        // appends the result to out and returns true on success, out is unchanged on failure.
+        bool invoke(std::string& out) { return args && bound && args->invoke(out); }
+
+      private:
+        friend class registry;
+
+        std::unique_ptr<detail::prepared_args> args;
+        bool bound = false;
+    };
+
+    namespace detail
+    {
+        // mixes a hash with a seed, for perfect hashing
+        constexpr std::uint64_t mix(std::uint64_t h, std::uint64_t seed)
+        {
+            h ^= (seed + 1) * 0x9e3779b97f4a7c15;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccd;
+            h ^= h >> 33;
+            return h;
+        }
+
+        // FNV-1a, a hash usable at compile time
+        constexpr std::uint64_t fnv1a(std::string_view s)
+        {
+            std::uint64_t h = 0xcbf29ce484222325;
+            for(auto c : s)
+            {
+                h ^= (unsigned char)c;
+                h *= 0x100000001b3;
+            }
+            return h;
+        }
+
+        // frozen_table is a minimal perfect hash table over a fixed set of names, built by hash
+        // and displace: names are grouped into buckets by their hash, and each bucket is given
+        // a seed with which its names hash to free slots. Looking up a name then takes one
+        // hash, one seeded mix and one comparison. The table points into the range it's built
+        // from, which must outlive it and not move its elements.
+        template <typename Slot>
+        class frozen_table
+        {
+          public:
+            frozen_table() = default;
+
+            // builds the table from a range of Slots with distinct names, returns false if no
+            // perfect hash is found, in which case the table is empty.
+            template <typename Range>
+            bool build(const Range& entries)
+            {
+                size_t n = std::size(entries);
+                seeds.assign(n, 0);
+                slots.clear();
+                if(n == 0)
+                    return true;
+
+                std::vector<std::vector<std::uint64_t>> buckets(n);
+                for(auto& e : entries)
+                {
+                    auto h = hash(e.name);
+                    buckets[h % n].push_back(h);
+                }
+                std::vector<size_t> order(n);
+                for(size_t i = 0; i < n; i++)
+                    order[i] = i;
+                std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                    return buckets[a].size() > buckets[b].size();
+                });
+
+                std::vector<bool> taken(n);
+                std::vector<size_t> placed;
+                for(auto b : order)
+                {
+                    if(buckets[b].empty())
+                        break;
+                    bool ok = false;
+                    for(std::uint32_t seed = 0; seed < max_seed && !ok; seed++)
+                    {
+                        placed.clear();
+                        ok = true;
+                        for(auto h : buckets[b])
+                        {
+                            auto i = mix(h, seed) % n;
+                            if(taken[i])
+                            {
+                                ok = false;
+                                break;
+                            }
+                            taken[i] = true;
+                            placed.push_back(i);
+                        }
+                        if(!ok)
+                            for(auto i : placed)
+                                taken[i] = false;
+                        else
+                            seeds[b] = seed;
+                    }
+                    if(!ok)
+                    {
+                        seeds.clear();
+                        return false;
+                    }
+                }
+
+                slots.resize(n);
+                for(auto& e : entries)
+                {
+                    auto h = hash(e.name);
+                    slots[mix(h, seeds[h % n]) % n] = {h, &e};
+                }
+                return true;
+            }
+
+            bool empty() const { return slots.empty(); }
+
+            const Slot* find(std::string_view name) const
+            {
+                if(slots.empty())
+                    return nullptr;
+                auto h = hash(name);
+                auto& s = slots[mix(h, seeds[h % slots.size()]) % slots.size()];
+                if(s.hash != h || s.ptr->name != name)
+                    return nullptr;
+                return s.ptr;
+            }
+
+            // points the table at a copy of the range it was built from, whose elements start
+            // at to where the original's start at from
+            void rebase(const Slot* from, const Slot* to)
+            {
+                for(auto& s : slots)
+                    s.ptr = to + (s.ptr - from);
+            }
+
+          private:
+            static constexpr std::uint32_t max_seed = 1 << 24;
+
+            static std::uint64_t hash(std::string_view name)
+            {
+                return std::hash<std::string_view>{}(name);
+            }
+
+            // the hash is compared first so that most misses don't touch the Slot
+            struct entry
+            {
+                std::uint64_t hash = 0;
+                const Slot* ptr = nullptr;
+            };
+
+            std::vector<std::uint32_t> seeds; // seed of each bucket
+            std::vector<entry> slots;
+        };
+    } // namespace detail
+
+    namespace detail
+    {
+        // flat_table is an open addressing hash table from names to overload_sets in the style
+        // of Swiss tables. Each slot has a control byte holding 7 bits of its name's hash, which
+        // are compared 16 slots at a time before comparing any name. Slots are stored inline,
+        // short names included thanks to the small string optimization.
+        class flat_table
+        {
+          public:
+            struct slot
+            {
+                std::string name;
+                overload_set funcs;
+            };
+
+            class iterator
+            {
+              public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = slot;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const slot*;
+                using reference = const slot&;
+
+                iterator() = default;
+                iterator(const flat_table* t, size_t i) : t{t}, i{i} { skip(); }
+
+                const slot& operator*() const { return t->slots[i]; }
+                const slot* operator->() const { return &t->slots[i]; }
+                iterator& operator++()
+                {
+                    ++i;
+                    skip();
+                    return *this;
+                }
+                iterator operator++(int)
+                {
+                    auto it = *this;
+                    ++*this;
+                    return it;
+                }
+                friend bool operator==(iterator a, iterator b) { return a.i == b.i; }
+
+              private:
+                void skip()
+                {
+                    while(i < t->ctrl.size() && t->ctrl[i] < 0)
+                        ++i;
+                }
+
+                const flat_table* t = nullptr;
+                size_t i = 0;
+            };
+
+            size_t size() const { return count; }
+            iterator begin() const { return {this, 0}; }
+            // the slots in memory order, including empty ones
+            const slot* data() const { return slots.data(); }
+            iterator end() const { return {this, ctrl.size()}; }
+
+            const slot* find(std::string_view name) const
+            {
+                if(count == 0)
+                    return nullptr;
+                auto h = hash(name);
+                auto h2 = std::int8_t(h & 0x7f);
+                for(auto g = first_group(h), step = size_t(0);; g = next_group(g, ++step))
+                {
+                    auto group = ctrl.data() + g * group_size;
+                    for(auto m = match(group, h2); m; m &= m - 1)
+                    {
+                        auto& s = slots[g * group_size + std::countr_zero(m)];
+                        if(s.name == name)
+                            return &s;
+                    }
+                    if(match(group, empty))
+                        return nullptr;
+                }
+            }
+
+            slot* find(std::string_view name)
+            {
+                return const_cast<slot*>(std::as_const(*this).find(name));
+            }
+
+            // registers funcs as name, replacing the functions registered as name if any
+            void insert_or_assign(std::string_view name, overload_set funcs)
+            {
+                if(auto s = find(name))
+                {
+                    s->funcs = std::move(funcs);
+                    return;
+                }
+                if((count + tombstones + 1) * 8 > ctrl.size() * 7)
+                    rehash(count + 1 > ctrl.size() * 7 / 16 ? ctrl.size() * 2 : ctrl.size());
+                insert_new(std::string{name}, std::move(funcs));
+            }
+
+            // returns whether there was a function registered as name
+            bool erase(std::string_view name)
+            {
+                auto s = find(name);
+                if(!s)
+                    return false;
+                auto i = size_t(s - slots.data());
+                auto group = ctrl.data() + i / group_size * group_size;
+                // a group that has never been full doesn't continue any probe sequence
+                if(match(group, empty))
+                    ctrl[i] = empty;
+                else
+                {
+                    ctrl[i] = deleted;
+                    tombstones++;
+                }
+                *s = {};
+                count--;
+                return true;
+            }
+
+          private:
+            static constexpr size_t group_size = 16;
+            static constexpr std::int8_t empty = -128;
+            static constexpr std::int8_t deleted = -2;
+
+            static std::uint64_t hash(std::string_view name)
+            {
+                return std::hash<std::string_view>{}(name);
+            }
+
+            size_t first_group(std::uint64_t h) const
+            {
+                return (h >> 7) & (ctrl.size() / group_size - 1);
+            }
+
+            // triangular probing visits every group when their number is a power of two
+            size_t next_group(size_t g, size_t step) const
+            {
+                return (g + step) & (ctrl.size() / group_size - 1);
+            }
+
+            // bitmask of the control bytes in the group that equal c
+            static std::uint32_t match(const std::int8_t* group, std::int8_t c)
+            {
+#ifdef CMD_SIMD_X86
+                auto v = _mm_loadu_si128((const __m128i*)group);
+                return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+#else
+                std::uint32_t m = 0;
+                for(size_t i = 0; i < group_size; i++)
+                    m |= std::uint32_t(group[i] == c) << i;
+                return m;
+#endif
+            }
+
+            // bitmask of the empty or deleted control bytes in the group
+            static std::uint32_t match_free(const std::int8_t* group)
+            {
+#ifdef CMD_SIMD_X86
+                return unsigned(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group)));
+#else
+                std::uint32_t m = 0;
+                for(size_t i = 0; i < group_size; i++)
+                    m |= std::uint32_t(group[i] < 0) << i;
+                return m;
+#endif
+            }
+
+            void insert_new(std::string&& name, overload_set&& funcs)
+            {
+                auto h = hash(name);
+                for(auto g = first_group(h), step = size_t(0);; g = next_group(g, ++step))
+                {
+                    if(auto m = match_free(ctrl.data() + g * group_size))
+                    {
+                        auto i = g * group_size + std::countr_zero(m);
+                        if(ctrl[i] == deleted)
+                            tombstones--;
+                        ctrl[i] = std::int8_t(h & 0x7f);
+                        slots[i] = {std::move(name), std::move(funcs)};
+                        count++;
+                        return;
+                    }
+                }
+            }
+
+            void rehash(size_t capacity)
+            {
+                capacity = (std::max)(capacity, group_size);
+                auto old = std::move(slots);
+                auto old_ctrl = std::move(ctrl);
+                ctrl.assign(capacity, empty);
+                slots.clear();
+                slots.resize(capacity);
+                count = tombstones = 0;
+                for(size_t i = 0; i < old_ctrl.size(); i++)
+                    if(old_ctrl[i] >= 0)
+                        insert_new(std::move(old[i].name), std::move(old[i].funcs));
+            }
+
+            std::vector<std::int8_t> ctrl; // the control byte of each slot
+            std::vector<slot> slots;
+            size_t count = 0;
+            size_t tombstones = 0; // deleted slots
+        };
+    } // namespace detail
+
+    // call_context owns the buffers used by registry::call, reusing it across calls avoids
+    // heap allocations once the buffers have grown to fit, provided the arguments and return
+    // value don't allocate themselves.
+    // A call_context is used by one thread at a time.
+    class call_context
+    {
+      public:
+        // the result of the last successful call
+        std::string_view result() const { return out; }
+
+      private:
+        friend class registry;
+        template <typename...>
+        friend class static_registry;
+
+        // starts scanning a line with c, which scans into storage, by its command name.
+        // The arguments are left to be pulled from c. fails on an unclosed quote or an empty
+        // line.
+        errc scan_name(token_cursor& c, std::string_view& name)
+        {
+            toks.clear();
+            auto tok = c.next();
+            if(c.quote())
+                return errc::unclosed_quote;
+            if(!tok)
+                return errc::empty_line;
+            name = *tok;
+            return {};
+        }
+
+        // describes a failure to call line, which was scanned by c as far as the failing token.
+        // Overloads are called once every token is scanned into toks, which is empty otherwise.
+        call_error error(token_cursor& c, std::string_view line, detail::status st)
+        {
+            if(toks.size() > 0)
+                return error(line, st.code, st.arg);
+            if(st.code == errc::empty_line)
+                return {st.code, 0, 0};
+            if(st.code == errc::wrong_arity)
+            {
+                if(c.at_end())
+                    return {st.code, st.arg, line.size()};
+                // the first extra token is scanned, as overloads do, in case it's unclosed
+                auto offset = c.offset();
+                c.next();
+                if(c.quote())
+                    return {errc::unclosed_quote, st.arg, offset};
+                return {st.code, st.arg, offset};
+            }
+            return {st.code, st.arg, c.offset()};
+        }
+
+        // describes a failure to call line, which was scanned into toks. The failing token is
+        // found by rescanning line up to it, which doesn't allocate since storage already fits.
+        // A view into line doesn't tell whether it was opened by a quote.
+        call_error error(std::string_view line, errc code, size_t arg = 0)
+        {
+            size_t tok = 0; // index of the failing token
+            if(code == errc::unclosed_quote)
+                tok = toks.size() - 1;
+            else if(code == errc::wrong_arity || code == errc::bad_argument)
+                tok = arg + 1;
+            else if(code == errc::empty_line)
+                return {code, 0, 0};
+
+            if(tok >= toks.size())
+                return {code, arg, line.size()};
+            token_cursor c{line, storage};
+            for(size_t i = 0; c.next(); i++)
+                if(i == tok)
+                    return {code, arg, c.offset()};
+            return {code, arg, line.size()};
+        }
+
+        std::string storage; // spliced tokens
+        std::vector<std::string_view> toks;
+        std::string out;
+    };
+
+    // batch_result holds the results of registry::call_batch back to back in a single buffer.
+    // Clearing it keeps its capacity, so it can be reused across batches without allocating.
+    class batch_result
+    {
+      public:
+        size_t size() const { return ends.size(); }
+
+        // whether line i was called successfully
+        bool ok(size_t i) const { return oks[i]; }
+
+        // the result of line i, empty if it failed
+        std::string_view operator[](size_t i) const
+        {
+            auto begin = i > 0 ? ends[i - 1] : 0;
+            return std::string_view{out}.substr(begin, ends[i] - begin);
+        }
+
+        // all results concatenated
+        std::string_view bytes() const { return out; }
+
+        void clear()
+        {
+            out.clear();
+            ends.clear();
+            oks.clear();
+        }
+
+      private:
+        friend class registry;
+        friend class batch_executor;
+
+        call_context ctx;
+        std::string out;
+        std::vector<size_t> ends; // end offsets of the results in out
+        std::vector<bool> oks;
+    };
+
+    // registry holds registered functions that can later be called command line style with
+    // full type-safety, e.g.
+    //      int foo(int);
+    //      registry r;
+    //      r.register_func("foo", &foo);
+    //      auto opt = r.call("foo 42");
+    // calls foo(42) and returns  the result as as an std::optional<std::string>.
+    // The arguments are parsed like bash, supporting quoting.
+    // If parsing fails, opt is empty and the function isn't called. The line is scanned lazily,
+    // each argument is converted as soon as it is scanned and a call fails at the first argument
+    // that is missing, extra or doesn't convert, without scanning the rest of the line.
+    // The string is tokenized and converted to their respective arguments by calling
+    //      from_string<T>{}(token);
+    // The return value of the function is converted to std::string by
+    //      to_string<T>{}(return_value);
+    // Calling is const and may be done concurrently, as long as the registry isn't modified.
+    // A registry that is no longer modified can be frozen, indexing its names with a perfect hash.
+    class registry
+    {
+      public:
+        registry() = default;
+        // a copy of a frozen registry is frozen
+        registry(const registry& other) : table{other.table}, frozen{other.frozen}
+        {
+            frozen.rebase(other.table.data(), table.data());
+        }
+        registry(registry&&) = default;
+        registry& operator=(const registry& other) { return *this = registry{other}; }
+        registry& operator=(registry&&) = default;
+
+        std::optional<std::string> call(std::string_view line) const
+        {
+            call_context ctx;
+            if(!call(ctx, line, ctx.out))
+                return {};
+            return std::move(ctx.out);
+        }
+
+        // Same as call(line), but the result is written into ctx and is valid until ctx is
+        // used again.
+        std::optional<std::string_view> call(call_context& ctx, std::string_view line) const
+        {
+            ctx.out.clear();
+            if(!call(ctx, line, ctx.out))
+                return {};
+            return std::string_view{ctx.out};
+        }
+
+        // Same as above, but a failure holds why it failed, see call_error. Failing doesn't
+        // allocate or throw, and costs little more than the work done up to the failure.
+        result<std::string_view> try_call(call_context& ctx, std::string_view line) const
+        {
+            ctx.out.clear();
+            if(auto res = try_call(ctx, line, ctx.out); !res)
+                return res.error();
+            return std::string_view{ctx.out};
+        }
+
+        template <sink S>
+        result<void> try_call(call_context& ctx, std::string_view line, S& out) const
+        {
+            token_cursor c{line, ctx.storage};
+            entry last;
+            if(auto st = call_line(ctx, c, out, last); !st)
+                return ctx.error(c, line, st);
+            return {};
+        }
+
+        // Same as above, but the result is appended to out, such as an output buffer, without
+        // an intermediate std::string. returns whether it succeeded, out is unchanged on failure.
+        template <sink S>
+        bool call(call_context& ctx, std::string_view line, S& out) const
+        {
+            token_cursor c{line, ctx.storage};
+            entry last;
+            return bool(call_line(ctx, c, out, last));
+        }
+
+        // calls the function registered as name with typed arguments, e.g.
+        //      r.invoke<int>("foo", 42);
+        // The result is empty, or false for void, if the name is unrecognized or the signature
+        // doesn't match R(Args...) up to references and cv-qualifiers. See erased_func::invoke.
+        template <typename R, typename... Args>
+        detail::optional_result<R> invoke(std::string_view name, Args&&... args) const
+        {
+            std::string_view stored;
+            auto fs = find(name, stored);
+            if(!fs)
+                return {};
+
+            return fs->template invoke<R>(std::forward<Args>(args)...);
+        }
+
+        // resolves the command and converts its constant arguments once, returns an empty
+        // prepared_command on failure. See prepared_command.
+        prepared_command prepare(std::string_view line) const
+        {
+            std::string storage;
+            auto [toks, quote] = tokenize(line, storage);
+            if(quote || toks.empty())
+                return {};
+
+            std::string_view stored;
+            auto fs = find(toks[0], stored);
+            if(!fs)
+                return {};
+
+            prepared_command cmd;
+            cmd.args = fs->prepare(line, toks.size() - 1);
+            cmd.bound = cmd.args && cmd.args->holes.empty();
+            return cmd;
+        }
+
+        // calls each of lines, the results are written into results, which is cleared first.
+        // Buffers are reused across lines and consecutive calls to the same name are looked up
+        // once.
+        void call_batch(std::span<const std::string_view> lines, batch_result& results) const
+        {
+            results.clear();
+            entry last;
+            for(auto line : lines)
+                call_batch_line(line, results, last);
+        }
+
+        // Same as above, with the lines separated by newlines in a single buffer.
+        void call_batch(std::string_view lines, batch_result& results) const
+        {
+            results.clear();
+            entry last;
+            detail::for_each_line(
+                lines, [&](std::string_view line) { call_batch_line(line, results, last); });
+        }
+
+        // calls each line of script in order, such as a memory mapped file, and passes the
+        // results to on_result as std::optional<std::string_view>, which are only valid during
+        // the call. The lines aren't copied.
+        template <typename F>
+        void run_script(std::string_view script, F&& on_result) const
+        {
+            call_context ctx;
+            detail::for_each_line(
+                script, [&](std::string_view line) { on_result(call(ctx, line)); });
+        }
+
+        std::optional<std::string> call(std::string_view name,
+                                        std::span<const std::string_view> toks) const
+        {
+            std::string_view stored;
+            auto fs = find(name, stored);
+            if(!fs)
+                return {};
+
+            return fs->call(toks);
+        }
+
+        std::optional<std::string> call(std::string_view name, token_list_view toks) const
+        {
+            std::string_view stored;
+            auto fs = find(name, stored);
+            if(!fs)
+                return {};
+
+            return fs->call(toks);
+        }
+
+        std::optional<std::string> call(std::string_view name, std::span<std::string> toks) const
+        {
+            std::string_view stored;
+            auto fs = find(name, stored);
+            if(!fs)
+                return {};
+
+            return fs->call(toks);
+        }
+
+        // appends the result to out, returns whether it succeeded, out is unchanged on failure.
+        template <sink S>
+        bool call(std::string_view name, std::span<const std::string_view> toks, S& out) const
+        {
+            std::string_view stored;
+            auto fs = find(name, stored);
+            return fs && fs->call(toks, out);
+        }
+
+        template <sink S>
+        bool call(std::string_view name, token_list_view toks, S& out) const
+        {
+            std::string_view stored;
+            auto fs = find(name, stored);
+            return fs && fs->call(toks, out);
+        }
+
+        // registers the function as name, replacing any function registered as name.
+        // fn is a function pointer or a callable, see erased_func.
+        template <typename F>
+        requires stringable_callable<F> void register_func(std::string_view name, F&& fn)
+        {
+            frozen = {};
+            table.insert_or_assign(name, erased_func{std::forward<F>(fn)});
+        }
+
+        // registers the function as an overload of name, calls are dispatched by the number of
+        // tokens, then to the first overload in registration order whose arguments convert.
+        // returns false without registering it if it is ambiguous, that is if an overload
+        // registered before takes the same number of arguments, each accepting every token
+        // this one's does, so that it would never be called: the same type, a string, or a
+        // wider number, such as double or long long for int.
+        template <typename F>
+        requires stringable_callable<F> bool register_overload(std::string_view name, F&& fn)
+        {
+            auto s = table.find(name);
+            if(!s)
+            {
+                register_func(name, std::forward<F>(fn));
+                return true;
+            }
+            if(!s->funcs.add(erased_func{std::forward<F>(fn)}))
+                return false;
+            frozen = {};
+            return true;
+        }
+
+        // returns whether any function was registered as name, removing all its overloads
+        bool remove(std::string_view name)
+        {
+            if(!table.erase(name))
+                return false;
+            frozen = {};
+            return true;
+        }
+
+        bool contains(std::string_view name) const { return find(name); }
+
+        // the function registered as name, the first one if there are overloads, null if
+        // there is none. The pointer is invalidated by registering or removing functions.
+        const erased_func* find(std::string_view name) const
+        {
+            std::string_view stored;
+            auto fs = find(name, stored);
+            return fs ? fs->front() : nullptr;
+        }
+
+        // indexes the registered names with a minimal perfect hash, looking up a name then
+        // takes one hash and one comparison, see bench/registry_lookup.cpp for how that compares
+        // to the default table. Registering or removing functions unfreezes.
+        // returns whether it succeeded, which fails only if names collide in their 64-bit hash.
+        bool freeze() { return frozen.build(table); }
+
+        bool is_frozen() const { return !frozen.empty(); }
+
+      private:
+
+        // the functions looked up along with their name as stored
+        struct entry
+        {
+            const detail::overload_set* funcs = nullptr;
+            std::string_view name;
+        };
+
+        const detail::overload_set* find(std::string_view name, std::string_view& stored) const
+        {
+            if(!frozen.empty())
+            {
+                auto s = frozen.find(name);
+                if(!s)
+                    return nullptr;
+                stored = s->name;
+                return &s->funcs;
+            }
+
+            auto s = table.find(name);
+            if(!s)
+                return nullptr;
+            stored = s->name;
+            return &s->funcs;
+        }
+
+        // scans the command name with c, looks it up and calls it with the arguments pulled
+        // from c, appending the result to out.
+        // last is the entry previously looked up in this batch, if any, repeating its name
+        // skips the lookup, and is updated to the entry found.
+        template <sink S>
+        detail::status call_line(call_context& ctx, token_cursor& c, S& out, entry& last) const
+        {
+            std::string_view name;
+            if(auto code = ctx.scan_name(c, name); code != errc{})
+                return {code};
+
+            if(!last.funcs || last.name != name)
+            {
+                entry found;
+                found.funcs = find(name, found.name);
+                if(!found.funcs)
+                    return {errc::unknown_command};
+                last = found;
+            }
+            return last.funcs->call(c, name, ctx.toks, out);
+        }
+
+        void call_batch_line(std::string_view line, batch_result& results, entry& last) const
+        {
+            token_cursor c{line, results.ctx.storage};
+            bool ok = bool(call_line(results.ctx, c, results.out, last));
+            results.ends.push_back(results.out.size());
+            results.oks.push_back(ok);
+        }
+
+        detail::flat_table table;
+        detail::frozen_table<detail::flat_table::slot> frozen;
+    };
+
+    // fixed_string is a string usable as a template argument, see static_registry
+    template <size_t N>
+    struct fixed_string
+    {
+        constexpr fixed_string(const char (&s)[N]) { std::copy_n(s, N, data); }
+        constexpr std::string_view view() const { return {data, N - 1}; }
+
+        char data[N] = {};
+    };
+
+    // command names a function of a static_registry
+    template <fixed_string Name, auto Fn>
+    struct command
+    {
+        static constexpr std::string_view name = Name.view();
+        static constexpr auto fn = Fn;
+    };
+
+    namespace detail
+    {
+        template <typename R, typename... Args>
+        constexpr bool is_stringable_func(R (*)(Args...))
+        {
+            return stringable<R, Args...>;
+        }
+    } // namespace detail
+
+    // static_registry is a registry fixed at compile time, e.g.
+    //      int foo(int);
+    //      static_registry<command<"foo", &foo>> r;
+    //      auto opt = r.call("foo 42");
+    // has the same semantics as registry::call. Names are looked up by a minimal perfect hash
+    // computed at compile time, and the functions are called directly so they can be inlined.
+    template <typename... Commands>
+    class static_registry
+    {
+        static constexpr size_t n = sizeof...(Commands);
+        static constexpr std::array<std::string_view, n> names = {Commands::name...};
+
+        // the perfect hash, where the command with hash h is slots[mix(h, seeds[h % n]) % n].
+        // Built by hash and displace as in detail::frozen_table.
+        struct perfect_hash
+        {
+            std::array<std::uint32_t, n> seeds{};
+            std::array<size_t, n> slots{};
+        };
+
+        static constexpr perfect_hash make_hash()
+        {
+            perfect_hash ph;
+            std::array<std::uint64_t, n> hashes{};
+            std::array<size_t, n> sizes{}, order{};
+            for(size_t i = 0; i < n; i++)
+            {
+                hashes[i] = detail::fnv1a(names[i]);
+                sizes[hashes[i] % n]++;
+                order[i] = i;
+            }
+            // buckets from largest to smallest
+            for(size_t i = 0; i < n; i++)
+                for(size_t j = i + 1; j < n; j++)
+                    if(sizes[order[j]] > sizes[order[i]])
+                        std::swap(order[i], order[j]);
+
+            std::array<bool, n> taken{};
+            for(auto b : order)
+            {
+                for(std::uint32_t seed = 0;; seed++)
+                {
+                    auto tried = taken;
+                    bool ok = true;
+                    for(size_t i = 0; i < n && ok; i++)
+                    {
+                        if(hashes[i] % n != b)
+                            continue;
+                        auto slot = detail::mix(hashes[i], seed) % n;
+                        ok = !tried[slot];
+                        tried[slot] = true;
+                    }
+                    if(ok)
+                    {
+                        ph.seeds[b] = seed;
+                        taken = tried;
+                        break;
+                    }
+                }
+            }
+            for(size_t i = 0; i < n; i++)
+                ph.slots[detail::mix(hashes[i], ph.seeds[hashes[i] % n]) % n] = i;
+            return ph;
+        }
+
+        static constexpr bool distinct_names()
+        {
+            for(size_t i = 0; i < n; i++)
+                for(size_t j = i + 1; j < n; j++)
+                    if(names[i] == names[j])
+                        return false;
+            return true;
+        }
+
+        static_assert(distinct_names(), "command names must be distinct");
+        static_assert((detail::is_stringable_func(Commands::fn) && ...));
+
+        static constexpr perfect_hash hash = make_hash();
+
+        template <typename Toks, typename Out>
+        static detail::status dispatch(size_t i, Toks&& toks, Out& out)
+        {
+            return detail::index_upto<n>([&](auto... is) {
+                detail::status st;
+                ((i == is &&
+                  (st = detail::dispatch(std::tuple_element_t<is, std::tuple<Commands...>>::fn,
+                                         toks, out),
+                   true)),
+                 ...);
+                return st;
+            });
+        }
+
+      public:
+        // the index of the command named name, the number of commands if there is none
+        static constexpr size_t index_of(std::string_view name)
+        {
+            if constexpr(n == 0)
+                return 0;
+            else
+            {
+                auto h = detail::fnv1a(name);
+                auto i = hash.slots[detail::mix(h, hash.seeds[h % n]) % n];
+                return names[i] == name ? i : n;
+            }
+        }
+
+        static constexpr bool contains(std::string_view name) { return index_of(name) < n; }
+
+        // Same as registry::call(line).
+        std::optional<std::string> call(std::string_view line) const
+        {
+            call_context ctx;
+            if(!call(ctx, line, ctx.out))
+                return {};
+            return std::move(ctx.out);
+        }
+
+        // Same as registry::call(ctx, line).
+        std::optional<std::string_view> call(call_context& ctx, std::string_view line) const
+        {
+            ctx.out.clear();
+            if(!call(ctx, line, ctx.out))
+                return {};
+            return std::string_view{ctx.out};
+        }
+
+        // Same as registry::call(ctx, line, out), the sink is appended to directly.
+        template <sink S>
+        bool call(call_context& ctx, std::string_view line, S& out) const
+        {
+            token_cursor c{line, ctx.storage};
+            return bool(call_line(ctx, c, out));
+        }
+
+        // Same as registry::try_call.
+        result<std::string_view> try_call(call_context& ctx, std::string_view line) const
+        {
+            ctx.out.clear();
+            if(auto res = try_call(ctx, line, ctx.out); !res)
+                return res.error();
+            return std::string_view{ctx.out};
+        }
+
+        template <sink S>
+        result<void> try_call(call_context& ctx, std::string_view line, S& out) const
+        {
+            token_cursor c{line, ctx.storage};
+            if(auto st = call_line(ctx, c, out); !st)
+                return ctx.error(c, line, st);
+            return {};
+        }
+
+        std::optional<std::string> call(std::string_view name,
+                                        std::span<const std::string_view> toks) const
+        {
+            return call_toks(name, toks);
+        }
+
+        std::optional<std::string> call(std::string_view name, token_list_view toks) const
+        {
+            return call_toks(name, toks);
+        }
+
+        template <sink S>
+        bool call(std::string_view name, std::span<const std::string_view> toks, S& out) const
+        {
+            auto i = index_of(name);
+            return i < n && dispatch(i, toks, out);
+        }
+
+        template <sink S>
+        bool call(std::string_view name, token_list_view toks, S& out) const
+        {
+            auto i = index_of(name);
+            return i < n && dispatch(i, toks, out);
+        }
+
+      private:
+        template <typename Toks>
+        static std::optional<std::string> call_toks(std::string_view name, Toks toks)
+        {
+            auto i = index_of(name);
+            std::string out;
+            if(i == n || !dispatch(i, toks, out))
+                return {};
+            return out;
+        }
+
+        // Same as registry::call_line, without overloads or caching the lookup
+        template <typename Out>
+        static detail::status call_line(call_context& ctx, token_cursor& c, Out& out)
+        {
+            std::string_view name;
+            if(auto code = ctx.scan_name(c, name); code != errc{})
+                return {code};
+            auto i = index_of(name);
+            if(i == n)
+                return {errc::unknown_command};
+            return dispatch(i, c, out);
+        }
+    };
+
+    // concurrent_registry is a registry that can be modified while it is being called from
+    // other threads. Calls read an immutable, frozen snapshot of the registry and are wait-free,
+    // each modification publishes a new snapshot. A snapshot is destroyed once no reader is
+    // within an epoch that could have seen it, which the modifying thread waits for.
+    // Calls go through a reader, one per thread, e.g.
+    //      concurrent_registry cr;
+    //      cr.register_func("foo", &foo);
+    //      // on each calling thread
+    //      concurrent_registry::reader rd{cr};
+    //      auto opt = rd.call("foo 42");
+    class concurrent_registry
+    {
+        struct alignas(64) reader_slot
+        {
+            std::atomic<std::uint64_t> epoch = 0; // the epoch it is reading in, 0 if none
+            bool used = false;
+        };
+
+      public:
+        class reader
+        {
+          public:
+            explicit reader(concurrent_registry& cr) : cr{&cr}, slot{cr.claim()} {}
+            reader(const reader&) = delete;
+            reader& operator=(const reader&) = delete;
+            ~reader() { cr->release(slot); }
+
+            // calls f with the current snapshot as a const registry&, f must not use the
+            // reader again.
+            template <typename F>
+            decltype(auto) read(F&& f)
+            {
+                slot->epoch.store(cr->epoch.load());
+                struct leave
+                {
+                    reader_slot* slot;
+                    ~leave() { slot->epoch.store(0, std::memory_order_release); }
+                } l{slot};
+                return std::forward<F>(f)(*cr->current.load());
+            }
+
+            // Same as registry::call(ctx, line), with the reader's own call_context.
+            std::optional<std::string_view> call(std::string_view line)
+            {
+                return read([&](const registry& r) { return r.call(ctx, line); });
+            }
+
+            // Same as registry::call(ctx, line, out).
+            template <sink S>
+            bool call(std::string_view line, S& out)
+            {
+                return read([&](const registry& r) { return r.call(ctx, line, out); });
+            }
+
+            // Same as registry::try_call(ctx, line).
+            result<std::string_view> try_call(std::string_view line)
+            {
+                return read([&](const registry& r) { return r.try_call(ctx, line); });
+            }
+
+          private:
+            concurrent_registry* cr;
+            reader_slot* slot;
+            call_context ctx;
+        };
+
+        concurrent_registry() : concurrent_registry{registry{}} {}
+        explicit concurrent_registry(registry r)
+        {
+            r.freeze();
+            current.store(new registry{std::move(r)});
+        }
+
+        concurrent_registry(const concurrent_registry&) = delete;
+        concurrent_registry& operator=(const concurrent_registry&) = delete;
+
+        // all readers must have been destroyed
+        ~concurrent_registry() { delete current.load(); }
+
+        template <typename F>
+        requires stringable_callable<F> void register_func(std::string_view name, F&& fn)
+        {
+            update([&](registry& r) { r.register_func(name, std::forward<F>(fn)); });
+        }
+
+        template <typename F>
+        requires stringable_callable<F> bool register_overload(std::string_view name, F&& fn)
+        {
+            bool added = false;
+            update([&](registry& r) { added = r.register_overload(name, std::forward<F>(fn)); });
+            return added;
+        }
+
+        bool remove(std::string_view name)
+        {
+            bool removed = false;
+            update([&](registry& r) { removed = r.remove(name); });
+            return removed;
+        }
+
+        // calls f with a copy of the current snapshot as a registry& and publishes it, for
+        // making several modifications at once. Returns once the old snapshot is destroyed.
+        template <typename F>
+        void update(F&& f)
+        {
+            std::lock_guard lock{mtx};
+            auto next = std::make_unique<registry>(*current.load());
+            std::forward<F>(f)(*next);
+            next->freeze();
+
+            auto old = current.exchange(next.release());
+            auto old_epoch = epoch.fetch_add(1);
+            // a reader that saw old announced an epoch no later than old_epoch before loading
+            // it, readers announcing afterwards see the new snapshot
+            for(auto& s : slots)
+            {
+                while(true)
+                {
+                    auto e = s->epoch.load();
+                    if(e == 0 || e > old_epoch)
+                        break;
+                    std::this_thread::yield();
+                }
+            }
+            delete old;
+        }
+
+      private:
+        reader_slot* claim()
+        {
+            std::lock_guard lock{mtx};
+            for(auto& s : slots)
+            {
+                if(!s->used)
+                {
+                    s->used = true;
+                    return s.get();
+                }
+            }
+            slots.push_back(std::make_unique<reader_slot>());
+            slots.back()->used = true;
+            return slots.back().get();
+        }
+
+        void release(reader_slot* slot)
+        {
+            std::lock_guard lock{mtx};
+            slot->used = false;
+        }
+
+        std::atomic<const registry*> current = nullptr;
+        std::atomic<std::uint64_t> epoch = 1;
+        std::mutex mtx; // serializes modifications and claiming slots
+        std::vector<std::unique_ptr<reader_slot>> slots;
+    };
+
+    // batch_executor calls batches of lines in parallel on a pool of threads, the calling thread
+    // included. Lines are claimed in chunks from a shared counter, so a few slow commands don't
+    // stall the other threads. The results are in the same order as the lines.
+    // The registry must not be modified during a batch and the registered functions must be
+    // safe to call concurrently.
+    class batch_executor
+    {
+      public:
+        explicit batch_executor(size_t threads = std::thread::hardware_concurrency())
+        {
+            for(size_t i = 1; i < threads; i++)
+                workers.emplace_back([this] { work(); });
+        }
+
+        batch_executor(const batch_executor&) = delete;
+        batch_executor& operator=(const batch_executor&) = delete;
+
+        ~batch_executor()
+        {
+            {
+                std::lock_guard lock{mtx};
+                stop = true;
+            }
+            wake.notify_all();
+            for(auto& t : workers)
+                t.join();
+        }
+
+        // Same as registry::call_batch, with the lines called in parallel.
+        void call_batch(const registry& reg, std::span<const std::string_view> lines,
+                        batch_result& results)
+        {
+            auto threads = workers.size() + 1;
+            auto chunk = (std::max<size_t>)(16, lines.size() / (threads * 16));
+            auto chunks = (lines.size() + chunk - 1) / chunk;
+            if(parts.size() < chunks)
+                parts.resize(chunks);
+
+            {
+                std::lock_guard lock{mtx};
+                job = {&reg, lines, chunk, chunks};
+                next = 0;
+                pending = workers.size();
+                generation++;
+            }
+            wake.notify_all();
+            run();
+            {
+                std::unique_lock lock{mtx};
+                done.wait(lock, [&] { return pending == 0; });
+            }
+
+            results.clear();
+            for(size_t i = 0; i < chunks; i++)
+            {
+                auto& part = parts[i];
+                auto base = results.out.size();
+                results.out += part.out;
+                for(auto end : part.ends)
+                    results.ends.push_back(base + end);
+                results.oks.insert(results.oks.end(), part.oks.begin(), part.oks.end());
+            }
+        }
+
+        // Same as above, with the lines separated by newlines in a single buffer.
+        void call_batch(const registry& reg, std::string_view lines, batch_result& results)
+        {
+            split.clear();
+            detail::for_each_line(lines, [&](std::string_view line) { split.push_back(line); });
+            call_batch(reg, split, results);
+        }
+
+        // Same as registry::run_script, with the lines called in parallel.
+        // The script is cut at newlines into segments of about segment_size bytes per thread,
+        // which are called one after another, so memory use doesn't grow with the script.
+        // The commands must be independent of each other.
+        template <typename F>
+        void run_script(const registry& reg, std::string_view script, F&& on_result,
+                        size_t segment_size = 1 << 20)
+        {
+            auto size = segment_size * (workers.size() + 1);
+            batch_result results;
+            while(script.size() > 0)
+            {
+                auto end = script.size() > size ? script.find('\n', size) : script.npos;
+                call_batch(reg, script.substr(0, end), results);
+                for(size_t i = 0; i < results.size(); i++)
+                {
+                    if(results.ok(i))
+                        on_result(std::optional<std::string_view>{results[i]});
+                    else
+                        on_result(std::optional<std::string_view>{});
+                }
+                if(end == script.npos)
+                    break;
+                script = script.substr(end + 1);
+            }
+        }
+
+      private:
+        struct batch_job
+        {
+            const registry* reg = nullptr;
+            std::span<const std::string_view> lines;
+            size_t chunk = 0;
+            size_t chunks = 0;
+        };
+
+        void work()
+        {
+            size_t seen = 0;
+            while(true)
+            {
+                {
+                    std::unique_lock lock{mtx};
+                    wake.wait(lock, [&] { return stop || generation != seen; });
+                    if(stop)
+                        return;
+                    seen = generation;
+                }
+                run();
+                {
+                    std::lock_guard lock{mtx};
+                    if(--pending == 0)
+                        done.notify_one();
+                }
+            }
+        }
+
+        // calls chunks until there are none left
+        void run()
+        {
+            for(size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < job.chunks;)
+                job.reg->call_batch(job.lines.subspan(i * job.chunk).first(
+                                        (std::min)(job.chunk, job.lines.size() - i * job.chunk)),
+                                    parts[i]);
+        }
+
+        std::vector<std::thread> workers;
+        std::mutex mtx;
+        std::condition_variable wake, done;
+        bool stop = false;
+        size_t generation = 0;
+        size_t pending = 0; // workers yet to finish the current batch
+
+        batch_job job;
+        std::atomic<size_t> next = 0;   // the next chunk to claim
+        std::vector<batch_result> parts; // results of each chunk, reused across batches
+        std::vector<std::string_view> split;
+    };
+} // namespace cmd
+
+#endif
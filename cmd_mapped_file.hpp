@@ -0,0 +1,137 @@
+#ifndef CMD_MAPPED_FILE_HPP_INCLUDED
+#define CMD_MAPPED_FILE_HPP_INCLUDED
+
+// mapped_file is kept apart from cmd.hpp, which only includes the standard library, as it needs
+// the platform's headers
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+// windows.h without the min and max macros and the rarely used headers, restoring the macros
+// that select them afterwards so that other includes are unaffected
+#ifndef NOMINMAX
+#define NOMINMAX
+#define CMD_DEFINED_NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#define CMD_DEFINED_WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#ifdef CMD_DEFINED_NOMINMAX
+#undef NOMINMAX
+#undef CMD_DEFINED_NOMINMAX
+#endif
+#ifdef CMD_DEFINED_WIN32_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#undef CMD_DEFINED_WIN32_LEAN_AND_MEAN
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cmd
+{
+    using std::size_t;
+
+    // mapped_file maps a file into memory read-only, for running scripts without copying them.
+    // mapped_file is move-only.
+    class mapped_file
+    {
+      public:
+        mapped_file() = default;
+
+        // check whether mapping succeeded with operator bool
+        explicit mapped_file(const char* path)
+        {
+#ifdef _WIN32
+            auto file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if(file == INVALID_HANDLE_VALUE)
+                return;
+            LARGE_INTEGER size;
+            if(!GetFileSizeEx(file, &size))
+                size.QuadPart = -1;
+            if(size.QuadPart == 0)
+                opened = true;
+            else if(size.QuadPart > 0)
+            {
+                if(auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+                {
+                    data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(mapping);
+                    if(data)
+                    {
+                        len = size_t(size.QuadPart);
+                        opened = true;
+                    }
+                }
+            }
+            CloseHandle(file);
+#else
+            auto fd = ::open(path, O_RDONLY);
+            if(fd < 0)
+                return;
+            struct stat st;
+            if(fstat(fd, &st) != 0)
+                st.st_size = -1;
+            if(st.st_size == 0)
+                opened = true;
+            else if(st.st_size > 0)
+            {
+                auto p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if(p != MAP_FAILED)
+                {
+                    madvise(p, size_t(st.st_size), MADV_SEQUENTIAL);
+                    data = (const char*)p;
+                    len = size_t(st.st_size);
+                    opened = true;
+                }
+            }
+            ::close(fd);
+#endif
+        }
+
+        mapped_file(mapped_file&& other) noexcept
+            : data{std::exchange(other.data, nullptr)}, len{std::exchange(other.len, 0)},
+              opened{std::exchange(other.opened, false)}
+        {
+        }
+
+        mapped_file& operator=(mapped_file&& other) noexcept
+        {
+            mapped_file tmp{std::move(other)};
+            std::swap(data, tmp.data);
+            std::swap(len, tmp.len);
+            std::swap(opened, tmp.opened);
+            return *this;
+        }
+
+        ~mapped_file()
+        {
+            if(!data)
+                return;
+#ifdef _WIN32
+            UnmapViewOfFile(data);
+#else
+            munmap((void*)data, len);
+#endif
+        }
+
+        explicit operator bool() const { return opened; }
+
+        std::string_view view() const { return {data, len}; }
+
+      private:
+        const char* data = nullptr;
+        size_t len = 0;
+        bool opened = false;
+    };
+} // namespace cmd
+
+#endif
@@ -0,0 +1,114 @@
+// registry::call with a warmed up call_context doesn't allocate for integral and string_view
+// signatures
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <cstdlib>
+#include <new>
+#include <string_view>
+
+// gcc can't see through the replaced operators once they're inlined into their callers
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static size_t allocations = 0;
+
+void* operator new(size_t n)
+{
+    ++allocations;
+    if(auto p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static int add(int a, int b) { return a + b; }
+static long long scale(long long x, unsigned k) { return x * k; }
+static int compare(std::string_view a, std::string_view b) { return a.compare(b); }
+static size_t length(std::string_view s) { return s.size(); }
+static void nop() {}
+
+// calls each line with ctx repeatedly, counting the allocations after the first round
+static size_t allocations_after_warmup(const cmd::registry& r, cmd::call_context& ctx,
+                                       std::initializer_list<std::string_view> lines)
+{
+    for(auto line : lines)
+        CHECK(r.call(ctx, line));
+    auto before = allocations;
+    for(int i = 0; i < 1000; i++)
+        for(auto line : lines)
+            CHECK(r.call(ctx, line));
+    return allocations - before;
+}
+
+int main()
+{
+    cmd::registry r;
+    r.register_func("add", &add);
+    r.register_func("scale", &scale);
+    r.register_func("compare", &compare);
+    r.register_func("length", &length);
+    r.register_func("nop", &nop);
+    r.register_func("a_command_name_longer_than_any_small_string", &add);
+
+    cmd::call_context ctx;
+    CHECK(*r.call(ctx, "add 1 2") == "3");
+    CHECK(*r.call(ctx, "compare 'a b' 'a b'") == "0");
+
+    CHECK(allocations_after_warmup(r, ctx,
+                                   {
+                                       "add 1 2",
+                                       "add -2147483648 2147483647",
+                                       "scale 123456789012 1000",
+                                       "compare hello world",
+                                       "compare \"quoted \\\"and\\\" spliced\" x",
+                                       "length 'a longer argument than fits in a small string'",
+                                       "nop",
+                                       "a_command_name_longer_than_any_small_string 1 2",
+                                   }) == 0);
+
+    // looking up names that don't fit in a small string doesn't allocate, frozen or not
+    constexpr std::string_view long_name = "a_command_name_longer_than_any_small_string";
+    constexpr std::string_view long_missing = "a_missing_name_longer_than_any_small_string";
+    for(int frozen = 0; frozen < 2; frozen++)
+    {
+        if(frozen)
+            r.freeze();
+        auto before = allocations;
+        for(int i = 0; i < 1000; i++)
+        {
+            CHECK(r.contains(long_name) && !r.contains(long_missing));
+            CHECK(r.find(long_name) && !r.find(long_missing));
+        }
+        CHECK(allocations == before);
+        CHECK(allocations_after_warmup(
+                  r, ctx, {"a_command_name_longer_than_any_small_string 40 2"}) == 0);
+    }
+
+    // failures don't allocate either
+    CHECK(allocations_after_warmup(r, ctx, {"add 1 2"}) == 0);
+    auto before = allocations;
+    for(int i = 0; i < 1000; i++)
+    {
+        CHECK(!r.call(ctx, "add 1"));
+        CHECK(!r.call(ctx, "add 1 x"));
+        CHECK(!r.call(ctx, "missing 1 2"));
+        CHECK(!r.try_call(ctx, "add 1 'unclosed"));
+    }
+    CHECK(allocations == before);
+
+    // neither does appending to a sink that already fits
+    std::string out;
+    out.reserve(1024);
+    before = allocations;
+    for(int i = 0; i < 1000; i++)
+    {
+        out.clear();
+        CHECK(r.call(ctx, "add 40 2", out) && out == "42");
+    }
+    CHECK(allocations == before);
+}
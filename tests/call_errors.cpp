@@ -0,0 +1,105 @@
+// try_call reports the same code, argument and offset whether a name has a single function,
+// overloads or is in a static_registry
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+static int add(int a, int b) { return a + b; }
+static int add4(std::string_view, std::string_view, std::string_view, std::string_view)
+{
+    return 4;
+}
+
+struct expected
+{
+    std::string_view line;
+    cmd::errc code;
+    size_t arg;
+    size_t offset;
+};
+
+template <typename R>
+static bool check(const R& r, const expected& e)
+{
+    cmd::call_context ctx;
+    auto err = r.try_call(ctx, e.line).error();
+    if(err.code == e.code && err.arg == e.arg && err.offset == e.offset)
+        return true;
+    std::printf("\"%.*s\": got code %d arg %zu offset %zu, expected %d %zu %zu\n",
+                int(e.line.size()), e.line.data(), int(err.code), err.arg, err.offset,
+                int(e.code), e.arg, e.offset);
+    return false;
+}
+
+int main()
+{
+    using enum cmd::errc;
+
+    cmd::registry single;
+    single.register_func("add", &add);
+
+    // the same name with an overload taking more arguments than any line below
+    cmd::registry overloaded;
+    overloaded.register_overload("add", &add);
+    overloaded.register_overload("add", &add4);
+
+    cmd::static_registry<cmd::command<"add", &add>> fixed;
+
+    constexpr expected common[] = {
+        {"add 1 2", cmd::errc{}, 0, 0},
+        {"add 1 2 ''", cmd::errc{}, 0, 0},
+        {"", empty_line, 0, 0},
+        {"   ", empty_line, 0, 0},
+        {"'add 1 2", unclosed_quote, 0, 0},
+        {"sub 1 2", unknown_command, 0, 0},
+        {"  sub", unknown_command, 0, 2},
+        {"add", wrong_arity, 0, 3},
+        {"add 1", wrong_arity, 1, 5},
+        {"add 1 ''", wrong_arity, 1, 8},
+        {"add 1 2 3", wrong_arity, 2, 8},
+        {"add 1 2   3", wrong_arity, 2, 10},
+        {"add 1 2 \"\"x", wrong_arity, 2, 10},
+        {"add 1 2 'x y'", wrong_arity, 2, 8},
+        {"add x 2", bad_argument, 0, 4},
+        {"add 1 x", bad_argument, 1, 6},
+        {"add \"\"x 1", bad_argument, 0, 6},
+        {"add 'x' 1", bad_argument, 0, 4},
+        {"add 1 2 '", unclosed_quote, 2, 8},
+        {"add 1 2 'x y", unclosed_quote, 2, 8},
+        {"add 1 2 ''\"x", unclosed_quote, 2, 10},
+        {"add 1 'x", unclosed_quote, 1, 6},
+        {"add 1 x'y", unclosed_quote, 1, 6},
+    };
+    for(auto& e : common)
+    {
+        CHECK(check(single, e));
+        CHECK(check(overloaded, e));
+        CHECK(check(fixed, e));
+    }
+
+    // a single function fails at the first failure in the line, overloads scan the line to
+    // count its tokens, up to one more than any of them takes, and dispatch by that count
+    constexpr expected first_failure[] = {
+        {"add 1 2 3 'x", wrong_arity, 2, 8},
+        {"add x 'y", bad_argument, 0, 4},
+        {"add 1 2 3 4 5", wrong_arity, 2, 8},
+    };
+    constexpr expected whole_line[] = {
+        {"add 1 2 3 'x", unclosed_quote, 3, 10},
+        {"add x 'y", unclosed_quote, 1, 6},
+        {"add 1 2 3 4 5", wrong_arity, 4, 12},
+        {"add 1 2 3 4 'x", unclosed_quote, 4, 12},
+        {"add 1 2 3 4 5 'x", wrong_arity, 4, 12},
+    };
+    for(auto& e : first_failure)
+    {
+        CHECK(check(single, e));
+        CHECK(check(fixed, e));
+    }
+    for(auto& e : whole_line)
+        CHECK(check(overloaded, e));
+}
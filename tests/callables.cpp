@@ -0,0 +1,61 @@
+// only callables that can be called as const are registered, since calls are const and the
+// callables are copied along with the registry and into prepared commands
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <string>
+
+struct widget
+{
+    int n = 0;
+    int add(int x) { return n += x; }
+    int get() const { return n; }
+};
+
+struct const_functor
+{
+    int operator()(int x) const { return x; }
+};
+
+struct mutable_functor
+{
+    int operator()(int x) { return x; }
+};
+
+static int twice(int x) { return 2 * x; }
+
+int main()
+{
+    int n = 0;
+    auto counted = [&n](int x) { return n += x; };
+    auto mutable_lambda = [n = 0](int x) mutable { return n += x; };
+    widget w;
+
+    static_assert(cmd::stringable_callable<decltype(&twice)>);
+    static_assert(cmd::stringable_callable<decltype(counted)>);
+    static_assert(cmd::stringable_callable<const_functor>);
+    static_assert(cmd::stringable_callable<decltype(cmd::bind_member(&widget::add, &w))>);
+    static_assert(cmd::stringable_callable<decltype(cmd::bind_member(&widget::get, &w))>);
+    static_assert(!cmd::stringable_callable<decltype(mutable_lambda)>);
+    static_assert(!cmd::stringable_callable<mutable_functor>);
+
+    // state held outside the callable is shared by every copy
+    cmd::registry r;
+    r.register_func("count", counted);
+    r.register_func("add", cmd::bind_member(&widget::add, &w));
+    auto prepared = r.prepare("count 2");
+    auto copy = r;
+    CHECK(*r.call("count 1") == "1");
+    CHECK(*prepared.invoke() == "3");
+    CHECK(*copy.call("count 3") == "6");
+    r.freeze();
+    CHECK(*r.call("count 4") == "10" && n == 10);
+    CHECK(*r.call("add 5") == "5" && *copy.call("add 1") == "6" && w.n == 6);
+
+    cmd::concurrent_registry cr{r};
+    cmd::concurrent_registry::reader reader{cr};
+    CHECK(*reader.call("count 1") == "11");
+    cr.register_func("twice", &twice);
+    CHECK(*reader.call("count 1") == "12" && *reader.call("twice 6") == "12");
+}
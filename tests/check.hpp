@@ -0,0 +1,18 @@
+#ifndef CMD_TESTS_CHECK_HPP_INCLUDED
+#define CMD_TESTS_CHECK_HPP_INCLUDED
+
+#include <cstdio>
+#include <cstdlib>
+
+// CHECK fails the test with the condition and where it is, also when NDEBUG is defined
+#define CHECK(...)                                                                             \
+    do                                                                                         \
+    {                                                                                          \
+        if(!(__VA_ARGS__))                                                                     \
+        {                                                                                      \
+            std::fprintf(stderr, "%s:%d: failed %s\n", __FILE__, __LINE__, #__VA_ARGS__);     \
+            std::exit(1);                                                                      \
+        }                                                                                      \
+    } while(false)
+
+#endif
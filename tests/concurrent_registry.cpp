@@ -0,0 +1,109 @@
+// readers call a concurrent_registry while a writer registers, overloads and removes functions,
+// checking that every call sees a whole snapshot no older than the previous one
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// k held in heap memory, so that reading a destroyed snapshot is caught by sanitizers
+struct versioned
+{
+    std::vector<int> copies;
+
+    int operator()() const
+    {
+        for(auto c : copies)
+            CHECK(c == copies.front());
+        return copies.front();
+    }
+};
+
+static int add(int a, int b) { return a + b; }
+
+static int to_int(std::string_view s)
+{
+    int x = -1;
+    CHECK(std::from_chars(s.data(), s.data() + s.size(), x).ec == std::errc{});
+    return x;
+}
+
+int main()
+{
+    constexpr int updates = 2000;
+    const int readers = int(std::max(2u, std::min(std::thread::hardware_concurrency(), 8u)));
+
+    cmd::registry initial;
+    initial.register_func("add", &add);
+    initial.register_func("version", versioned{std::vector<int>(16, 0)});
+    cmd::concurrent_registry cr{std::move(initial)};
+
+    std::atomic<bool> done = false;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < readers; t++)
+    {
+        threads.emplace_back([&, t] {
+            int last = 0;
+            while(!done.load())
+            {
+                // readers come and go, reusing each other's slots
+                cmd::concurrent_registry::reader rd{cr};
+                for(int i = 0; i < 100; i++)
+                {
+                    CHECK(*rd.call("add 40 2") == "42");
+
+                    auto v = rd.call("version");
+                    CHECK(v);
+                    int k = to_int(*v);
+                    CHECK(k >= last && k <= updates);
+                    last = k;
+
+                    // tmp is registered on odd versions, with an overload on every fourth
+                    if(auto res = rd.try_call("tmp 1 2"))
+                        CHECK(*res == "3");
+                    else
+                        CHECK(res.error().code == cmd::errc::unknown_command ||
+                              res.error().code == cmd::errc::wrong_arity);
+                    if(auto res = rd.try_call("tmp 7"))
+                        CHECK(*res == "7");
+                    else
+                        CHECK(res.error().code == cmd::errc::unknown_command ||
+                              res.error().code == cmd::errc::wrong_arity);
+
+                    std::string out;
+                    CHECK(rd.call("add 1 " + std::to_string(t), out) &&
+                          out == std::to_string(1 + t));
+                }
+            }
+        });
+    }
+
+    for(int k = 1; k <= updates; k++)
+    {
+        if(k % 2 == 1)
+        {
+            cr.update([&](cmd::registry& r) {
+                r.register_func("version", versioned{std::vector<int>(16, k)});
+                r.register_func("tmp", [](int a, int b) { return a + b; });
+                if(k % 4 == 1)
+                    CHECK(r.register_overload("tmp", [](int a) { return a; }));
+            });
+        }
+        else
+        {
+            cr.register_func("version", versioned{std::vector<int>(16, k)});
+            CHECK(cr.remove("tmp"));
+        }
+    }
+    done.store(true);
+    for(auto& t : threads)
+        t.join();
+
+    cmd::concurrent_registry::reader rd{cr};
+    CHECK(*rd.call("version") == std::to_string(updates));
+    CHECK(!rd.call("tmp 1 2"));
+}
@@ -0,0 +1,156 @@
+// to_string of float, double and long double, plain and formatted, against std::to_chars: in
+// every format, shortest and at every precision up to 40 and a few longer ones, returned as a
+// string and appended to a std::string and to another sink, whose results longer than the
+// stack buffer go through a temporary string
+//
+// values are edge cases, powers of two and ten and their neighbours, and random bits
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+
+static long long cases = 0;
+
+// a sink other than std::string
+struct buffer
+{
+    std::string chars;
+
+    void append(const char* p, size_t n) { chars.append(p, n); }
+};
+
+template <typename T>
+static void compare(T x, std::optional<std::chars_format> format, int precision = -1)
+{
+    cases++;
+    static char buf[6000];
+    std::to_chars_result r;
+    if(!format)
+        r = std::to_chars(buf, buf + sizeof(buf), x);
+    else if(precision < 0)
+        r = std::to_chars(buf, buf + sizeof(buf), x, *format);
+    else
+        r = std::to_chars(buf, buf + sizeof(buf), x, *format, precision);
+    CHECK(r.ec == std::errc{});
+    std::string_view expected{buf, size_t(r.ptr - buf)};
+
+    std::string str = "prefix ";
+    buffer other{"prefix "};
+    std::string actual;
+    if(!format)
+    {
+        actual = cmd::to_string<T>{}(x);
+        cmd::to_string<T>{}(x, str);
+        cmd::to_string<T>{}(x, other);
+    }
+    else
+    {
+        cmd::formatted<T> f{x, *format, precision};
+        actual = cmd::to_string<cmd::formatted<T>>{}(f);
+        cmd::to_string<cmd::formatted<T>>{}(f, str);
+        cmd::to_string<cmd::formatted<T>>{}(f, other);
+    }
+    if(actual != expected || str.substr(7) != expected || other.chars.substr(7) != expected ||
+       !str.starts_with("prefix ") || !other.chars.starts_with("prefix "))
+    {
+        std::printf("%a as %s, format %d, precision %d: got \"%s\", \"%s\" and \"%s\", "
+                    "expected \"%.*s\"\n",
+                    double(x), sizeof(T) == 4 ? "float" : sizeof(T) == 8 ? "double" : "long double",
+                    format ? int(*format) : 0, precision, actual.c_str(), str.c_str(),
+                    other.chars.c_str(), int(expected.size()), expected.data());
+        std::exit(1);
+    }
+}
+
+constexpr std::chars_format formats[] = {std::chars_format::fixed, std::chars_format::scientific,
+                                         std::chars_format::general, std::chars_format::hex};
+
+// plain and in every format, shortest and at every precision in precisions
+template <typename T>
+static void compare_all(T x, std::initializer_list<int> precisions)
+{
+    compare(x, std::nullopt);
+    for(auto format : formats)
+    {
+        compare(x, format);
+        for(int precision : precisions)
+            compare(x, format, precision);
+    }
+}
+
+template <typename T>
+static void compare_every_precision(T x)
+{
+    compare_all(x, {0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13,  14,  15,  16,  17,
+                    18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
+                    37, 38, 39, 40, 50, 100, 400, 1100});
+}
+
+template <typename T>
+static void compare_edge_cases()
+{
+    using limits = std::numeric_limits<T>;
+    for(T x : {T(0), T(1), T(0.1), T(0.5), T(1.5), T(2.5), T(9.5), T(99.5), T(0.05), T(1e-5),
+               T(1e-4), T(123456), T(1234567), T(1e15), T(1e16), T(1e17), T(1e21), T(1e22),
+               T(1e23), T(0x1p23), T(0x1p24), T(0x1p53), T(0x1p63), T(0x1p64), T(0x1p100),
+               limits::denorm_min(), limits::min(), limits::max(), limits::epsilon(),
+               std::nextafter(limits::min(), T(0)), limits::infinity(), limits::quiet_NaN()})
+    {
+        compare_every_precision(x);
+        compare_every_precision(-x);
+    }
+    // the neighbours of powers of ten, where the digits roll over
+    for(int e = limits::min_exponent10 - 1; e <= limits::max_exponent10; e++)
+    {
+        auto p = std::pow(T(10), T(e));
+        for(T x : {p, std::nextafter(p, T(0)), std::nextafter(p, limits::infinity())})
+            compare_all(x, {0, 1, 2, 5, limits::max_digits10 - 1, limits::max_digits10});
+    }
+    // every power of two
+    for(int e = limits::min_exponent - limits::digits; e < limits::max_exponent; e++)
+        compare_all(std::ldexp(T(1), e), {0, 3, limits::max_digits10});
+}
+
+int main()
+{
+    compare_edge_cases<float>();
+    compare_edge_cases<double>();
+    for(long double x : {0.0L, 1.0L, 0.1L, 1e300L, 1e-300L,
+                         std::numeric_limits<long double>::max(),
+                         std::numeric_limits<long double>::denorm_min()})
+        compare_all(x, {0, 1, 10, 20, 30});
+
+    std::mt19937_64 rng{25};
+
+    // random bits, which are mostly of large and small magnitudes, at every precision
+    for(int i = 0; i < 2000; i++)
+    {
+        auto bits = rng();
+        double d;
+        std::memcpy(&d, &bits, 8);
+        float f;
+        auto fbits = std::uint32_t(bits >> 32);
+        std::memcpy(&f, &fbits, 4);
+        compare_every_precision(d);
+        compare_every_precision(f);
+    }
+
+    // random numbers of a human size, which fixed prints without exponents
+    for(int i = 0; i < 20000; i++)
+    {
+        auto x = double(rng() % 100000000) / std::pow(10.0, double(rng() % 16));
+        int precision = int(rng() % 25);
+        compare_all(x, {precision});
+        compare_all(float(x), {precision});
+    }
+    std::printf("%lld cases\n", cases);
+}
@@ -0,0 +1,300 @@
+// detail::parse_float against std::from_chars for float and double, comparing the value, ptr
+// and ec: on edge cases, at every decimal exponent, at halfway points between floats and on
+// random input. detail::powers_of_five is checked against its definition first. Built with and
+// without SIMD, see CMakeLists.txt.
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+static long long cases = 0;
+
+template <typename T>
+static void compare(const std::string& s)
+{
+    cases++;
+    T expected = T(-7), actual = T(-7);
+    auto first = s.data(), last = s.data() + s.size();
+    auto theirs = std::from_chars(first, last, expected);
+    auto ours = cmd::detail::parse_float(first, last, actual);
+    bool same = std::isnan(expected) ? std::isnan(actual) &&
+                                           std::signbit(expected) == std::signbit(actual)
+                                     : std::memcmp(&expected, &actual, sizeof(T)) == 0;
+    if(ours.ec != theirs.ec || ours.ptr != theirs.ptr || !same)
+    {
+        std::printf("\"%s\" as %s: got %.17g ec %d ptr %d, expected %.17g ec %d ptr %d\n",
+                    s.c_str(), sizeof(T) == 4 ? "float" : "double", double(actual),
+                    int(ours.ec), int(ours.ptr - first), double(expected), int(theirs.ec),
+                    int(theirs.ptr - first));
+        std::exit(1);
+    }
+}
+
+static void compare_both(const std::string& s)
+{
+    compare<float>(s);
+    compare<double>(s);
+}
+
+// an unsigned integer of any size, the least significant limb first
+struct big
+{
+    std::vector<std::uint32_t> limbs;
+
+    int bit_width() const
+    {
+        for(size_t i = limbs.size(); i-- > 0;)
+            if(limbs[i])
+                return int(32 * i) + std::bit_width(limbs[i]);
+        return 0;
+    }
+
+    bool bit(int i) const
+    {
+        return i >= 0 && size_t(i / 32) < limbs.size() && limbs[i / 32] >> i % 32 & 1;
+    }
+
+    // the 64 bits from bit i up, zeros below bit 0
+    std::uint64_t bits64(int i) const
+    {
+        std::uint64_t x = 0;
+        for(int k = 64; k-- > 0;)
+            x = x << 1 | bit(i + k);
+        return x;
+    }
+
+    void multiply(std::uint32_t m)
+    {
+        std::uint64_t carry = 0;
+        for(auto& l : limbs)
+        {
+            carry += std::uint64_t(l) * m;
+            l = std::uint32_t(carry);
+            carry >>= 32;
+        }
+        if(carry)
+            limbs.push_back(std::uint32_t(carry));
+    }
+
+    void add(std::uint32_t a)
+    {
+        for(size_t i = 0; a; i++)
+        {
+            if(i == limbs.size())
+                limbs.push_back(0);
+            auto s = std::uint64_t(limbs[i]) + a;
+            limbs[i] = std::uint32_t(s);
+            a = std::uint32_t(s >> 32);
+        }
+    }
+
+    // floor(2^b / d), bit by bit
+    static big power_of_two_over(int b, const big& d)
+    {
+        big q{std::vector<std::uint32_t>(size_t(b / 32 + 1))};
+        big r{std::vector<std::uint32_t>(d.limbs.size() + 1)};
+        for(int i = b + 1; i-- > 0;)
+        {
+            // r = 2r + bit i of 2^b
+            std::uint32_t carry = i == b;
+            for(auto& l : r.limbs)
+            {
+                auto next = l >> 31;
+                l = l << 1 | carry;
+                carry = next;
+            }
+            if(!r.less_than(d))
+            {
+                std::int64_t borrow = 0;
+                for(size_t k = 0; k < r.limbs.size(); k++)
+                {
+                    auto x = std::int64_t(r.limbs[k]) - borrow -
+                             (k < d.limbs.size() ? d.limbs[k] : 0);
+                    borrow = x < 0;
+                    r.limbs[k] = std::uint32_t(x + (borrow << 32));
+                }
+                q.limbs[i / 32] |= 1u << i % 32;
+            }
+        }
+        return q;
+    }
+
+    bool less_than(const big& o) const
+    {
+        for(size_t i = (std::max)(limbs.size(), o.limbs.size()); i-- > 0;)
+        {
+            auto a = i < limbs.size() ? limbs[i] : 0, b = i < o.limbs.size() ? o.limbs[i] : 0;
+            if(a != b)
+                return a < b;
+        }
+        return false;
+    }
+};
+
+// as in fast_float: 5^n truncated to its upper 128 bits, and 5^-n as floor(2^b / 5^n) + 1
+// truncated to 128 bits, where b is the width of 5^n plus 127 up to 5^27 and twice the width
+// plus 128 beyond
+static void check_powers_of_five()
+{
+    auto& table = cmd::detail::powers_of_five<>;
+    auto entry = [&](int q) {
+        return &table[2 * size_t(q - cmd::detail::min_power5)];
+    };
+    big p{{1}};
+    for(int n = 0; n <= -cmd::detail::min_power5; n++)
+    {
+        auto w = p.bit_width();
+        if(n <= cmd::detail::max_power5)
+        {
+            auto e = entry(n);
+            CHECK(e[0] == p.bits64(w - 64));
+            CHECK(e[1] == p.bits64(w - 128));
+        }
+        if(n > 0)
+        {
+            auto c = big::power_of_two_over(n <= 27 ? w + 127 : 2 * w + 128, p);
+            c.add(1);
+            auto cw = c.bit_width();
+            auto e = entry(-n);
+            CHECK(e[0] == c.bits64(cw - 64));
+            CHECK(e[1] == c.bits64(cw - 128));
+        }
+        p.multiply(5);
+    }
+    // the ends of the table, as published by fast_float
+    CHECK(entry(-342)[0] == 0xeef453d6923bd65a && entry(-342)[1] == 0x113faa2906a13b3f);
+    CHECK(entry(308)[0] == 0x8e679c2f5e44ff8f && entry(308)[1] == 0x570f09eaa7ea7648);
+}
+
+// the exact decimal expansions of the points halfway between x and the next T up, and those
+// expansions cut short or nudged by one in their last digit
+template <typename T, typename Wide>
+static void compare_halfway(T x)
+{
+    auto next = std::nextafter(x, std::numeric_limits<T>::infinity());
+    if(!std::isfinite(next))
+        return;
+    auto mid = (Wide(x) + Wide(next)) / 2;
+    char buf[1200];
+    int n = std::snprintf(buf, sizeof buf, "%.1100Le", (long double)mid);
+    std::string exact{buf, size_t(n)};
+    auto e = exact.find('e');
+    auto mantissa = exact.substr(0, e), exponent = exact.substr(e);
+    mantissa.erase(mantissa.find_last_not_of('0') + 1);
+    compare<T>(mantissa + exponent);
+    for(size_t len : {19, 20, 25, 40})
+        if(len < mantissa.size())
+            compare<T>(mantissa.substr(0, len) + exponent);
+    for(int d : {-1, 1})
+    {
+        auto nudged = mantissa;
+        auto& last = nudged.back();
+        if((d < 0 && last > '0') || (d > 0 && last < '9'))
+        {
+            last = char(last + d);
+            compare<T>(nudged + exponent);
+        }
+    }
+}
+
+int main()
+{
+    check_powers_of_five();
+
+    for(auto s : {"", "-", "+1", ".", "-.", ".e5", "1e", "1e+", "1e-", "1.e5", ".5", "5.", "-0",
+                  "0e999999999999", "1e309", "1e-400", "2e-324", "4.9e-324",
+                  "2.4703282292062327e-324", "2.4703282292062328e-324",
+                  "1.7976931348623157e308", "1.7976931348623158e308", "1.7976931348623159e308",
+                  "1e-46", "1e-45", "7.006492e-46", "7.0064924e-46", "3.4028235e38",
+                  "3.4028236e38", "3.40282357e38", "inf", "-Infinity", "INFINITY", "infinit",
+                  "nan", "NaN(abc)", "nan(", "nan(a b)", "nan()", "-nan(_9)", "in", "na",
+                  "1.5e400000000000000000000", "0.000000000000000000000000000000000000001e39",
+                  "00000000000000000000000000000001", "1234567890123456789012345678901234567890",
+                  "9007199254740993", "9007199254740993.000000000000001", "123.456e-5x", "1e22",
+                  "1e23", "123456789e-22", "0.1", "-0.0e-5", "1_000", "1..2", "1e1.5", "1E5",
+                  "0x1p3", "1e-0", "1e+0", "1e00000000000000000000000000000000000005",
+                  "1e-000000000000000000000000000000000000000000000000000000000000000000000300"})
+        compare_both(s);
+
+    // every byte after digits, which must end the number or be part of it
+    for(int c = 0; c < 256; c++)
+        for(auto s : {"1", "1.5", "1e5", "1e", "12345678901234567890", "nan", "inf"})
+            compare_both(s + std::string(1, char(c)) + "5");
+
+    std::mt19937_64 rng{5};
+
+    // random mantissas at every decimal exponent, which goes through every power of five,
+    // with up to 19 digits and more
+    for(int e = -360; e <= 330; e++)
+    {
+        for(int i = 0; i < 40; i++)
+        {
+            std::string s;
+            for(auto n = 1 + rng() % (i % 4 == 0 ? 40 : 19); n > 0; n--)
+                s += char('0' + rng() % 10);
+            compare_both(s + "e" + std::to_string(e));
+        }
+    }
+
+    // halfway points, as doubles for float and long doubles for double where those are wide
+    // enough to hold them
+    for(int i = 0; i < 2000; i++)
+    {
+        auto bits = rng();
+        float f;
+        std::uint32_t fbits = std::uint32_t(bits) & 0x7fffffff;
+        std::memcpy(&f, &fbits, 4);
+        if(std::isfinite(f))
+            compare_halfway<float, double>(f);
+        if constexpr(std::numeric_limits<long double>::digits >= 64)
+        {
+            double d;
+            bits &= 0x7fffffffffffffff;
+            std::memcpy(&d, &bits, 8);
+            if(std::isfinite(d))
+                compare_halfway<double, long double>(d);
+        }
+    }
+    for(auto f : {std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::min(),
+                  std::nextafter(std::numeric_limits<float>::max(), 0.0f), 1.0f})
+        compare_halfway<float, double>(f);
+
+    // random floats printed at every precision, and random strings of digits and junk
+    for(int i = 0; i < 100000; i++)
+    {
+        auto bits = rng();
+        double d;
+        std::memcpy(&d, &bits, 8);
+        char buf[64];
+        if(std::isfinite(d))
+        {
+            std::snprintf(buf, sizeof buf, "%.*g", 1 + i % 19, d);
+            compare<double>(buf);
+        }
+        if(auto f = float(d); std::isfinite(f))
+        {
+            std::snprintf(buf, sizeof buf, "%.*g", 1 + i % 10, double(f));
+            compare<float>(buf);
+        }
+
+        std::string s;
+        if(rng() % 4 == 0)
+            s += '-';
+        for(auto n = rng() % 30; n > 0; n--)
+        {
+            auto r = rng() % 40;
+            s += r < 30 ? char('0' + r % 10) : ".e-+ x"[r % 6];
+        }
+        compare_both(s);
+    }
+    std::printf("%lld cases\n", cases);
+}
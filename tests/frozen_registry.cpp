@@ -0,0 +1,65 @@
+// a frozen registry calls the very functions it was built from, without copying them, and its
+// copies are frozen over their own functions
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <string>
+
+static int copies = 0;
+
+// counts its calls, so that calling a copy is seen
+struct counter
+{
+    mutable int n = 0;
+
+    counter() = default;
+    counter(const counter& other) : n{other.n} { ++copies; }
+    counter(counter&& other) noexcept : n{other.n} {}
+
+    int operator()() const { return ++n; }
+};
+
+static int add(int a, int b) { return a + b; }
+
+int main()
+{
+    cmd::registry r;
+    r.register_func("inc", counter{});
+    for(int i = 0; i < 20; i++)
+        r.register_func("add" + std::to_string(i), &add);
+
+    CHECK(*r.call("inc") == "1");
+    CHECK(*r.call("inc") == "2");
+    int before = copies;
+    CHECK(r.freeze() && r.is_frozen());
+    CHECK(copies == before);
+    CHECK(*r.call("inc") == "3");
+    CHECK(*r.call("add7 1 2") == "3");
+
+    // unfreezing keeps calling the same function
+    r.register_func("other", &add);
+    CHECK(!r.is_frozen());
+    CHECK(*r.call("inc") == "4");
+
+    // a copy is frozen over its own functions
+    CHECK(r.freeze());
+    auto copy = r;
+    CHECK(copy.is_frozen());
+    CHECK(*copy.call("inc") == "5");
+    CHECK(*r.call("inc") == "5");
+    CHECK(*copy.call("add19 2 3") == "5");
+    r.remove("inc");
+    CHECK(!r.call("inc") && *copy.call("inc") == "6");
+
+    cmd::registry assigned;
+    assigned = copy;
+    CHECK(assigned.is_frozen() && *assigned.call("inc") == "7");
+    CHECK(*copy.call("inc") == "7");
+
+    // and moving keeps it frozen over the same functions
+    auto moved = std::move(copy);
+    CHECK(moved.is_frozen() && *moved.call("inc") == "8");
+    for(int i = 0; i < 20; i++)
+        CHECK(*moved.call("add" + std::to_string(i) + " 1 1") == "2");
+}
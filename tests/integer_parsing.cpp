@@ -0,0 +1,151 @@
+// detail::parse_integer against std::from_chars, comparing the value, ptr and ec: around the
+// limits of each type, at powers of ten, with every byte at every position of runs of digits
+// and on random digits. Built with and without SIMD, see CMakeLists.txt.
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+static long long cases = 0;
+
+template <typename T>
+static void compare(const std::string& s)
+{
+    cases++;
+    T expected = T(42), actual = T(42);
+    auto first = s.data(), last = s.data() + s.size();
+    auto res = std::from_chars(first, last, expected);
+    auto ours = cmd::detail::parse_integer(first, last, actual);
+    if(res.ptr != ours.ptr || res.ec != ours.ec || expected != actual)
+        std::fprintf(stderr, "\"%s\" parsed as %s: %lld, %d, %d rather than %lld, %d, %d\n",
+                     s.c_str(), typeid(T).name(), (long long)actual, int(ours.ec),
+                     int(ours.ptr - first), (long long)expected, int(res.ec),
+                     int(res.ptr - first));
+    CHECK(res.ptr == ours.ptr && res.ec == ours.ec && expected == actual);
+}
+
+// digits, a non-negative decimal, plus d, which doesn't make it negative
+static std::string add(std::string digits, int d)
+{
+    int carry = d;
+    for(auto i = digits.size(); i-- > 0 && carry != 0;)
+    {
+        int x = digits[i] - '0' + carry;
+        carry = x < 0 ? -((9 - x) / 10) : x / 10;
+        digits[i] = char('0' + (x - 10 * carry));
+    }
+    if(carry > 0)
+        digits.insert(digits.begin(), char('0' + carry));
+    auto nonzero = digits.find_first_not_of('0');
+    return nonzero == digits.npos ? "0" : digits.substr(nonzero);
+}
+
+// sign and magnitude plus d
+static std::string add(bool negative, const std::string& magnitude, int d)
+{
+    if(!negative)
+        return add(magnitude, d);
+    auto m = add(magnitude, -d);
+    return m == "0" ? m : "-" + m;
+}
+
+template <typename T>
+static void run(std::mt19937_64& rng)
+{
+    using L = std::numeric_limits<T>;
+    auto max = std::to_string(+L::max()), min = std::to_string(+L::min());
+    bool signed_min = min[0] == '-';
+    if(signed_min)
+        min.erase(0, 1);
+
+    std::vector<std::string> bases = {"", "-", "+1", "--1", " 1", "-0", "0x1"};
+    // the limits and their neighbours, also times 10, which are then past them
+    for(int d = -3; d <= 3; d++)
+    {
+        bases.push_back(std::to_string(d));
+        bases.push_back(add(false, max, d));
+        bases.push_back(add(false, max + "0", d));
+        if(signed_min)
+        {
+            bases.push_back(add(true, min, d));
+            bases.push_back(add(true, min + "0", d));
+        }
+    }
+    // powers of ten, all nines and leading zeros at every length up to 40 digits
+    for(size_t n = 1; n <= 40; n++)
+    {
+        bases.push_back("1" + std::string(n - 1, '0'));
+        bases.push_back(std::string(n, '9'));
+        bases.push_back("-" + std::string(n, '9'));
+        bases.push_back("-1" + std::string(n - 1, '0'));
+        bases.push_back(std::string(n, '0') + "7");
+    }
+    // leading zeros put the digits at every offset from the 8 and 16 digit blocks
+    const char* tails[] = {"", " ", "x", "/", ":", "-", "0", "\"", "\x80", "12345678x"};
+    for(auto& b : bases)
+    {
+        for(auto t : tails)
+        {
+            for(size_t zeros = 0; zeros <= 17; zeros++)
+            {
+                std::string z(zeros, '0');
+                if(b.size() > 0 && b[0] == '-')
+                    compare<T>("-" + z + b.substr(1) + t);
+                else
+                    compare<T>(z + b + t);
+            }
+        }
+    }
+
+    // every byte at every position of runs around the 8 and 16 digit blocks, which checks how
+    // digits are told apart from the bytes next to them
+    for(size_t n : {7, 8, 9, 15, 16, 17, 23, 24, 25, 33})
+    {
+        for(size_t pos = 0; pos < n; pos++)
+        {
+            for(int c = 0; c < 256; c++)
+            {
+                std::string s(n, '1');
+                s[pos] = char(c);
+                compare<T>(s);
+                compare<T>("-" + s);
+            }
+        }
+    }
+
+    // random digits with occasional junk
+    for(int i = 0; i < 100000; i++)
+    {
+        std::string s;
+        if(rng() % 4 == 0)
+            s += '-';
+        for(auto n = rng() % 26; n > 0; n--)
+            s += rng() % 20 ? char('0' + rng() % 10) : char(rng() % 256);
+        compare<T>(s);
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng{3};
+    run<char>(rng);
+    run<signed char>(rng);
+    run<unsigned char>(rng);
+    run<short>(rng);
+    run<unsigned short>(rng);
+    run<int>(rng);
+    run<unsigned>(rng);
+    run<long>(rng);
+    run<unsigned long>(rng);
+    run<long long>(rng);
+    run<unsigned long long>(rng);
+    std::printf("%lld cases\n", cases);
+}
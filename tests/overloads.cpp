@@ -0,0 +1,78 @@
+// overloads are rejected when an earlier one accepts every token they do, and are otherwise
+// called in registration order
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+template <typename... Args>
+static auto takes()
+{
+    return [](Args...) { return sizeof...(Args); };
+}
+
+int main()
+{
+    cmd::registry r;
+
+    // the same type, strings and wider numbers shadow
+    CHECK(r.register_overload("same", takes<int>()));
+    CHECK(!r.register_overload("same", takes<const int&>()));
+    CHECK(r.register_overload("string", takes<std::string_view>()));
+    CHECK(!r.register_overload("string", takes<std::string>()));
+    CHECK(!r.register_overload("string", takes<int>()));
+    CHECK(r.register_overload("floating", takes<double>()));
+    CHECK(!r.register_overload("floating", takes<int>()));
+    CHECK(!r.register_overload("floating", takes<unsigned long long>()));
+    CHECK(!r.register_overload("floating", takes<float>()));
+    CHECK(r.register_overload("float", takes<float>()));
+    CHECK(!r.register_overload("float", takes<long long>()));
+    CHECK(r.register_overload("wide", takes<long long>()));
+    CHECK(!r.register_overload("wide", takes<int>()));
+    CHECK(!r.register_overload("wide", takes<short>()));
+    CHECK(!r.register_overload("wide", takes<unsigned>()));
+    CHECK(r.register_overload("pair", takes<std::string, double>()));
+    CHECK(!r.register_overload("pair", takes<std::string_view, int>()));
+
+    // while narrower numbers, other signedness, other arities and floats after integers don't
+    CHECK(r.register_overload("narrow", takes<int>()));
+    CHECK(r.register_overload("narrow", takes<long long>()));
+    CHECK(r.register_overload("narrow", takes<double>()));
+    CHECK(r.register_overload("narrow", takes<std::string>()));
+    CHECK(r.register_overload("narrow", takes<int, int>()));
+    CHECK(r.register_overload("signed", takes<int>()));
+    CHECK(r.register_overload("signed", takes<unsigned>()));
+    CHECK(r.register_overload("unsigned", takes<unsigned long long>()));
+    CHECK(r.register_overload("unsigned", takes<long long>()));
+    CHECK(r.register_overload("mixed", takes<int, std::string>()));
+    CHECK(r.register_overload("mixed", takes<double, int>()));
+    CHECK(r.register_overload("double", takes<float>()));
+    CHECK(r.register_overload("double", takes<double>()));
+
+    // the first overload whose arguments convert is called
+    cmd::registry which;
+    which.register_overload("f", [](int) { return std::string{"int"}; });
+    which.register_overload("f", [](unsigned) { return std::string{"unsigned"}; });
+    which.register_overload("f", [](long long) { return std::string{"long long"}; });
+    which.register_overload("f", [](double) { return std::string{"double"}; });
+    which.register_overload("f", [](std::string_view) { return std::string{"string"}; });
+    CHECK(*which.call("f -1") == "int");
+    CHECK(*which.call("f 3000000000") == "unsigned");
+    CHECK(*which.call("f -3000000000") == "long long");
+    CHECK(*which.call("f 1e3") == "double");
+    CHECK(*which.call("f 99999999999999999999") == "double");
+    CHECK(*which.call("f x") == "string");
+
+    // a candidate failing after converting some tokens leaves them to the next one
+    cmd::registry moved;
+    moved.register_overload("f",
+                            [](std::string a, int b) { return a + "/int" + std::to_string(b); });
+    moved.register_overload("f", [](std::string a, std::string b) { return a + "/str" + b; });
+    std::vector<std::string> toks = {"abc", "x"};
+    CHECK(*moved.call("f", std::span<std::string>{toks}) == "abc/strx");
+    toks = {"abc", "1"};
+    CHECK(*moved.call("f", std::span<std::string>{toks}) == "abc/int1");
+}
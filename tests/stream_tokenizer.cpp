@@ -0,0 +1,78 @@
+// stream_tokenizer gives the same tokens as tokenize on each line, however the input is split
+// into chunks. The two keep separate copies of the quoting rules, this pins them together.
+
+#include "cmd.hpp"
+#include "check.hpp"
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using lines = std::vector<std::vector<std::string>>;
+
+// splits input into lines at the newlines outside of quotes, the only rule needed to find them
+static std::vector<std::string_view> split_lines(std::string_view input, char& quote)
+{
+    std::vector<std::string_view> ls;
+    quote = 0;
+    size_t begin = 0;
+    for(size_t i = 0; i < input.size(); i++)
+    {
+        auto c = input[i];
+        if(quote == 0 && (c == '"' || c == '\''))
+            quote = c;
+        else if(c == quote)
+            quote = 0;
+        else if(quote == 0 && c == '\n')
+        {
+            ls.push_back(input.substr(begin, i - begin));
+            begin = i + 1;
+        }
+    }
+    if(begin < input.size())
+        ls.push_back(input.substr(begin));
+    return ls;
+}
+
+int main()
+{
+    std::mt19937 rng{5};
+    const char alphabet[] = "ab \"'\n";
+    for(int it = 0; it < 200000; it++)
+    {
+        std::string input;
+        for(auto n = rng() % 24; n > 0; n--)
+            input += alphabet[rng() % 6];
+
+        char quote;
+        auto ls = split_lines(input, quote);
+        lines expected;
+        for(auto l : ls)
+        {
+            auto [toks, q] = cmd::tokenize(l);
+            expected.push_back(toks);
+        }
+        // an unclosed quote keeps the last line
+        if(quote)
+        {
+            CHECK(cmd::tokenize(ls.back()).second == quote);
+            expected.pop_back();
+        }
+
+        cmd::stream_tokenizer st;
+        lines actual;
+        auto on_line = [&](std::span<const std::string_view> toks) {
+            actual.emplace_back(toks.begin(), toks.end());
+        };
+        for(std::string_view rest = input; rest.size() > 0;)
+        {
+            auto n = std::min<size_t>(rest.size(), 1 + rng() % 8);
+            st.feed(rest.substr(0, n), on_line);
+            rest.remove_prefix(n);
+        }
+        CHECK(st.quote() == quote);
+        CHECK(st.finish(on_line) == quote);
+        CHECK(actual == expected);
+    }
+}